@@ -103,6 +103,18 @@ cbuffer BufferObject : register(b3)
     matrix g_object_wvp_previous;
 };
 
+// High frequency - Updates per instanced draw
+static const uint g_max_instances = 64; // must match max_instances in Renderer_ConstantBuffers.h
+struct Instance
+{
+    matrix transform;
+    matrix wvp_previous;
+};
+cbuffer BufferInstance : register(b5)
+{
+    Instance g_instances[g_max_instances];
+};
+
 // High frequency - Updates per light
 cbuffer LightBuffer : register(b4)
 {
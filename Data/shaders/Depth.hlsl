@@ -23,12 +23,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Common.hlsl"
 //====================
 
-Pixel_PosUv mainVS(Vertex_PosUv input)
+Pixel_PosUv mainVS(Vertex_PosUv input, uint instance_id : SV_InstanceID)
 {
     Pixel_PosUv output;
 
     input.position.w    = 1.0f; 
+    #if INSTANCED
+    output.position     = mul(mul(input.position, g_instances[instance_id].transform), g_transform); // g_transform is the view projection
+    #else
     output.position     = mul(input.position, g_object_transform);
+    #endif
     output.uv           = input.uv;
 
     return output;
@@ -78,6 +78,9 @@ namespace Spartan
 
     void Engine::Tick() const
     {
+        // Deliver the events which were queued during the previous frame (or by other threads)
+        EventSystem::Get().FireDeferredEvents();
+
         m_context->Tick(TickType::Variable, static_cast<float>(m_timer->GetDeltaTimeSec()));
         m_context->Tick(TickType::Smoothed, static_cast<float>(m_timer->GetDeltaTimeSmoothedSec()));
     }
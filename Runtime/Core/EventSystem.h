@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include <vector>
 #include <functional>
+#include <mutex>
 #include "../Core/Variant.h"
 //==========================
 
@@ -35,8 +36,13 @@ To subscribe a function to an event        -> SUBSCRIBE_TO_EVENT(EVENT_ID, Handl
 To unsubscribe a function from an event    -> SUBSCRIBE_TO_EVENT(EVENT_ID, Handler);
 To fire an event                        -> FIRE_EVENT(EVENT_ID);
 To fire an event with data                -> FIRE_EVENT_DATA(EVENT_ID, Variant);
+To fire an event at the start of the next frame -> FIRE_EVENT_DEFERRED(EVENT_ID);
 
-Note: Currently, this is a blocking event system
+Note: Fired events block until every subscriber has run, on the calling thread.
+Deferred events are queued instead (any thread can queue them). They are delivered
+on the engine thread at the start of the next frame, and repeats of an event that is
+still queued are merged into one (the last data wins). Large payloads should be passed
+by pointer (e.g. a pointer to a vector), as a Variant holds a copy.
 =================================================================================
 */
 
@@ -49,8 +55,6 @@ enum class EventType
     WorldLoad,                // The world must be loaded from file
     WorldLoaded,            // The world finished loading from file
     WorldUnload,            // The world should clear everything
-    WorldResolve,            // The world should resolve
-    WorldResolved,            // The world has finished resolving
     WorldStop,                // The world should stop ticking
     WorldStart,                // The world should start ticking
     FrameResolutionChanged
@@ -68,6 +72,8 @@ enum class EventType
 
 #define FIRE_EVENT(eventID)                            Spartan::EventSystem::Get().Fire(eventID)
 #define FIRE_EVENT_DATA(eventID, data)                Spartan::EventSystem::Get().Fire(eventID, data)
+#define FIRE_EVENT_DEFERRED(eventID)                Spartan::EventSystem::Get().FireDeferred(eventID)
+#define FIRE_EVENT_DEFERRED_DATA(eventID, data)        Spartan::EventSystem::Get().FireDeferred(eventID, data)
 
 #define SUBSCRIBE_TO_EVENT(eventID, function)        Spartan::EventSystem::Get().Subscribe(eventID, function);
 #define UNSUBSCRIBE_FROM_EVENT(eventID, function)    Spartan::EventSystem::Get().Unsubscribe(eventID, function);
@@ -88,20 +94,23 @@ namespace Spartan
 
         void Subscribe(const EventType event_id, subscriber&& function)
         {
+            std::lock_guard<std::mutex> lock(m_mutex_subscribers);
             m_subscribers[event_id].push_back(std::forward<subscriber>(function));
         }
 
         void Unsubscribe(const EventType event_id, subscriber&& function)
         {
+            std::lock_guard<std::mutex> lock(m_mutex_subscribers);
+
             const size_t function_adress    = *reinterpret_cast<long*>(reinterpret_cast<char*>(&function));
             auto& subscribers                = m_subscribers[event_id];
 
-            for (auto it = subscribers.begin(); it != subscribers.end();)
+            for (auto it = subscribers.begin(); it != subscribers.end(); it++)
             {
                 const size_t subscriber_adress = *reinterpret_cast<long*>(reinterpret_cast<char*>(&(*it)));
                 if (subscriber_adress == function_adress)
                 {
-                    it = subscribers.erase(it);
+                    subscribers.erase(it);
                     return;
                 }
             }
@@ -109,21 +118,69 @@ namespace Spartan
 
         void Fire(const EventType event_id, const Variant& data = 0)
         {
-            if (m_subscribers.find(event_id) == m_subscribers.end())
-                return;
+            // Invoke a copy of the subscribers, so that they can (un)subscribe, and other threads can fire, while this runs
+            std::vector<subscriber> subscribers;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_subscribers);
+
+                const auto it = m_subscribers.find(event_id);
+                if (it == m_subscribers.end())
+                    return;
+
+                subscribers = it->second;
+            }
 
-            for (const auto& subscriber : m_subscribers[event_id])
+            for (const auto& subscriber : subscribers)
             {
                 subscriber(data);
             }
         }
 
+        // Queues an event for FireDeferredEvents(), an event which is already queued only has its data replaced
+        void FireDeferred(const EventType event_id, const Variant& data = 0)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex_deferred);
+
+            for (auto& event : m_deferred)
+            {
+                if (event.first == event_id)
+                {
+                    event.second = data;
+                    return;
+                }
+            }
+
+            m_deferred.emplace_back(event_id, data);
+        }
+
+        // Fires the queued events, in the order they were first queued (the engine calls this at the start of every frame)
+        void FireDeferredEvents()
+        {
+            // Events fired by the subscribers go to the next batch
+            std::vector<std::pair<EventType, Variant>> events;
+            {
+                std::lock_guard<std::mutex> lock(m_mutex_deferred);
+                events.swap(m_deferred);
+            }
+
+            for (const auto& event : events)
+            {
+                Fire(event.first, event.second);
+            }
+        }
+
         void Clear() 
         {
-            m_subscribers.clear(); 
+            std::lock_guard<std::mutex> lock_subscribers(m_mutex_subscribers);
+            std::lock_guard<std::mutex> lock_deferred(m_mutex_deferred);
+            m_subscribers.clear();
+            m_deferred.clear();
         }
 
     private:
         std::unordered_map<EventType, std::vector<subscriber>> m_subscribers;
+        std::mutex m_mutex_subscribers;
+        std::vector<std::pair<EventType, Variant>> m_deferred;
+        std::mutex m_mutex_deferred;
     };
 }
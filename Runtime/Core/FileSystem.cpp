@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include <filesystem>
 #include <regex>
+#include <random>
 #include <windows.h>
 #include <shellapi.h>
 //===================
@@ -320,6 +321,39 @@ namespace Spartan
         }
     }
 
+    bool FileSystem::Rename(const string& source, const string& destination)
+    {
+        try
+        {
+            filesystem::rename(source, destination);
+            return true;
+        }
+        catch (filesystem::filesystem_error& e)
+        {
+            LOG_WARNING("%s", e.what());
+            return false;
+        }
+    }
+
+    string FileSystem::GetUniqueFilePath(const string& path)
+    {
+        // The machine and the process tell apart writers which share a directory (e.g. on a network drive), the random part tells apart threads
+        char machine_name[MAX_COMPUTERNAME_LENGTH + 1] = {};
+        DWORD machine_name_length = MAX_COMPUTERNAME_LENGTH + 1;
+        if (!GetComputerNameA(machine_name, &machine_name_length))
+        {
+            machine_name[0] = '\0';
+        }
+
+        random_device random;
+        const uint64_t value = (static_cast<uint64_t>(random()) << 32) | static_cast<uint64_t>(random());
+
+        char suffix[32];
+        snprintf(suffix, sizeof(suffix), "%08lx.%016llx", static_cast<unsigned long>(GetCurrentProcessId()), static_cast<unsigned long long>(value));
+
+        return path + "." + machine_name + "." + suffix + ".tmp";
+    }
+
     string FileSystem::GetFileNameFromFilePath(const string& path)
     {
         return filesystem::path(path).filename().generic_string();
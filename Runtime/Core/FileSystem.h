@@ -55,6 +55,8 @@ namespace Spartan
         static bool IsDirectory(const std::string& path);
         static bool IsFile(const std::string& path);
         static bool CopyFileFromTo(const std::string& source, const std::string& destination);
+        static bool Rename(const std::string& source, const std::string& destination);
+        static std::string GetUniqueFilePath(const std::string& path); // for temporaries, unique across threads, processes and machines
         static std::string GetFileNameFromFilePath(const std::string& path);
         static std::string GetFileNameNoExtensionFromFilePath(const std::string& path);
         static std::string GetDirectoryFromFilePath(const std::string& path);
@@ -52,6 +52,7 @@ namespace Spartan
     std::weak_ptr<Spartan::Entity>,                    \
     std::vector<std::weak_ptr<Spartan::Entity>>,    \
     std::vector<std::shared_ptr<Spartan::Entity>>,    \
+    std::vector<std::shared_ptr<Spartan::Entity>>*,    \
     Spartan::Math::Vector2,                            \
     Spartan::Math::Vector3,                            \
     Spartan::Math::Vector4,                            \
@@ -23,6 +23,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "FileStream.h"
 #include "../RHI/RHI_Vertex.h"
+#include <windows.h>
 //============================
 
 //= NAMESPACES =====
@@ -31,33 +32,59 @@ using namespace std;
 
 namespace Spartan
 {
+    // Writes smaller than this are gathered before they reach the OS, larger ones go straight through
+    static const uint64_t write_buffer_size = 1024 * 1024;
+
     FileStream::FileStream(const string& path, uint32_t flags)
     {
-        m_is_open    = false;
-        m_flags        = flags;
-
-        int ios_flags    = ios::binary;
-        ios_flags        |= (flags & FileStream_Read)    ? ios::in    : 0;
-        ios_flags        |= (flags & FileStream_Write)    ? ios::out    : 0;
-        ios_flags        |= (flags & FileStream_Append)    ? ios::app    : 0;
+        m_is_open   = false;
+        m_flags     = flags;
 
         if (m_flags & FileStream_Write)
         {
-            out.open(path, ios_flags);
-            if (out.fail())
+            int ios_flags   = ios::binary | ios::out;
+            ios_flags       |= (flags & FileStream_Append) ? ios::app : 0;
+
+            m_out.open(path, ios_flags);
+            if (m_out.fail())
             {
                 LOG_ERROR("Failed to open \"%s\" for writing", path.c_str());
                 return;
             }
+
+            m_write_buffer.reserve(write_buffer_size);
         }
         else if (m_flags & FileStream_Read)
         {
-            in.open(path, ios_flags);
-            if(in.fail())
+            HANDLE file = CreateFileW(FileSystem::StringToWstring(path).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
             {
                 LOG_ERROR("Failed to open \"%s\" for reading", path.c_str());
                 return;
             }
+            m_file = file;
+
+            LARGE_INTEGER size = {};
+            if (!GetFileSizeEx(file, &size))
+            {
+                LOG_ERROR("Failed to get the size of \"%s\"", path.c_str());
+                Close();
+                return;
+            }
+            m_size = static_cast<uint64_t>(size.QuadPart);
+
+            // Empty files can't be mapped, but they are valid (there is just nothing to read)
+            if (m_size != 0)
+            {
+                m_file_mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                m_data = m_file_mapping ? static_cast<const std::byte*>(MapViewOfFile(m_file_mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+                if (!m_data)
+                {
+                    LOG_ERROR("Failed to map \"%s\"", path.c_str());
+                    Close();
+                    return;
+                }
+            }
         }
 
         m_is_open = true;
@@ -72,14 +99,117 @@ namespace Spartan
     {
         if (m_flags & FileStream_Write)
         {
-            out.flush();
-            out.close();
+            if (m_out.is_open())
+            {
+                WriteFlush();
+                m_out.flush();
+                m_out.close();
+            }
         }
         else if (m_flags & FileStream_Read)
         {
-            in.clear();
-            in.close();
+            if (m_data)
+            {
+                UnmapViewOfFile(m_data);
+                m_data = nullptr;
+            }
+
+            if (m_file_mapping)
+            {
+                CloseHandle(m_file_mapping);
+                m_file_mapping = nullptr;
+            }
+
+            if (m_file)
+            {
+                CloseHandle(m_file);
+                m_file = nullptr;
+            }
+
+            m_size      = 0;
+            m_position  = 0;
         }
+
+        m_is_open = false;
+    }
+
+    uint64_t FileStream::GetPosition()
+    {
+        if (m_flags & FileStream_Write)
+            return static_cast<uint64_t>(m_out.tellp()) + m_write_buffer.size();
+
+        return m_position;
+    }
+
+    void FileStream::Seek(const uint64_t position)
+    {
+        if (m_flags & FileStream_Write)
+        {
+            WriteFlush();
+            m_out.seekp(position, ios::beg);
+        }
+        else if (m_flags & FileStream_Read)
+        {
+            m_position = position < m_size ? position : m_size;
+        }
+    }
+
+    void FileStream::WriteBytes(const void* data, const uint64_t size)
+    {
+        if (m_write_buffer.size() + size > write_buffer_size)
+        {
+            WriteFlush();
+        }
+
+        if (size >= write_buffer_size)
+        {
+            m_out.write(static_cast<const char*>(data), size);
+            return;
+        }
+
+        const std::byte* bytes = static_cast<const std::byte*>(data);
+        m_write_buffer.insert(m_write_buffer.end(), bytes, bytes + size);
+    }
+
+    void FileStream::WriteFlush()
+    {
+        if (m_write_buffer.empty())
+            return;
+
+        m_out.write(reinterpret_cast<const char*>(m_write_buffer.data()), m_write_buffer.size());
+        m_write_buffer.clear();
+    }
+
+    void FileStream::ReadBytes(void* data, const uint64_t size)
+    {
+        // Reading past the end yields zeros, instead of whatever the destination held
+        const uint64_t available = m_size - m_position;
+        const uint64_t read_size = size < available ? size : available;
+
+        if (read_size != 0)
+        {
+            memcpy(data, m_data + m_position, read_size);
+            m_position += read_size;
+        }
+
+        if (read_size != size)
+        {
+            memset(static_cast<std::byte*>(data) + read_size, 0, size - read_size);
+        }
+    }
+
+    const std::byte* FileStream::ReadView(const uint64_t size)
+    {
+        if (size > m_size - m_position)
+        {
+            m_position = m_size;
+            return nullptr;
+        }
+
+        const std::byte* data = m_data + m_position;
+        m_position += size;
+
+        return data;
     }
 
     void FileStream::Write(const string& value)
@@ -87,7 +217,7 @@ namespace Spartan
         const auto length = static_cast<uint32_t>(value.length());
         Write(length);
 
-        out.write(const_cast<char*>(value.c_str()), length);
+        WriteBytes(value.c_str(), length);
     }
 
     void FileStream::Write(const vector<string>& value)
@@ -105,28 +235,28 @@ namespace Spartan
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(RHI_Vertex_PosTexNorTan) * length);
+        WriteBytes(value.data(), sizeof(RHI_Vertex_PosTexNorTan) * length);
     }
 
     void FileStream::Write(const vector<uint32_t>& value)
     {
         const auto length = static_cast<uint32_t>(value.size());
         Write(length);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(uint32_t) * length);
+        WriteBytes(value.data(), sizeof(uint32_t) * length);
     }
 
     void FileStream::Write(const vector<unsigned char>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(unsigned char) * size);
+        WriteBytes(value.data(), sizeof(unsigned char) * size);
     }
 
     void FileStream::Write(const vector<std::byte>& value)
     {
         const auto size = static_cast<uint32_t>(value.size());
         Write(size);
-        out.write(reinterpret_cast<const char*>(&value[0]), sizeof(std::byte) * size);
+        WriteBytes(value.data(), sizeof(std::byte) * size);
     }
 
     void FileStream::Skip(uint32_t n)
@@ -134,11 +264,12 @@ namespace Spartan
         // Set the seek cursor to offset n from the current position
         if (m_flags & FileStream_Write)
         {
-            out.seekp(n, ios::cur);
+            WriteFlush();
+            m_out.seekp(n, ios::cur);
         }
         else if (m_flags & FileStream_Read)
         {
-            in.ignore(n, ios::cur);
+            Seek(m_position + n);
         }
     }
 
@@ -148,7 +279,7 @@ namespace Spartan
         Read(&length);
 
         value->resize(length);
-        in.read(const_cast<char*>(value->c_str()), length);
+        ReadBytes(value->data(), length);
     }
 
     void FileStream::Read(vector<string>* vec)
@@ -170,36 +301,33 @@ namespace Spartan
         }
     }
 
-    void FileStream::Read(vector<RHI_Vertex_PosTexNorTan>* vec)
+    // The arrays are copied straight out of the mapped file, and the vectors keep their capacity if it's large enough.
+    // The bytes are copied (not cast), as the array can start at any offset in the file.
+    template <class T>
+    void FileStream::ReadArray(vector<T>* vec)
     {
+        static_assert(is_trivially_copyable<T>::value, "Only trivially copyable elements can be read as bytes");
+
         if (!vec)
             return;
 
-        vec->clear();
-        vec->shrink_to_fit();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
+        const uint32_t count    = ReadAs<uint32_t>();
+        const std::byte* data   = ReadView(static_cast<uint64_t>(count) * sizeof(T));
+        vec->resize(data ? count : 0);
+        if (data && count != 0)
+        {
+            memcpy(vec->data(), data, static_cast<size_t>(count) * sizeof(T));
+        }
+    }
 
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(RHI_Vertex_PosTexNorTan) * length);
+    void FileStream::Read(vector<RHI_Vertex_PosTexNorTan>* vec)
+    {
+        ReadArray(vec);
     }
 
     void FileStream::Read(vector<uint32_t>* vec)
     {
-        if (!vec)
-            return;
-
-        vec->clear();
-        vec->shrink_to_fit();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(uint32_t) * length);
+        ReadArray(vec);
     }
 
     void FileStream::Read(vector<unsigned char>* vec)
@@ -207,15 +335,9 @@ namespace Spartan
         if (!vec)
             return;
 
-        vec->clear();
-        vec->shrink_to_fit();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(unsigned char) * length);
+        uint32_t count = 0;
+        const unsigned char* data = ReadSpan<unsigned char>(&count);
+        vec->assign(data, data + count);
     }
 
     void FileStream::Read(vector<std::byte>* vec)
@@ -223,14 +345,8 @@ namespace Spartan
         if (!vec)
             return;
 
-        vec->clear();
-        vec->shrink_to_fit();
-
-        const auto length = ReadAs<uint32_t>();
-
-        vec->reserve(length);
-        vec->resize(length);
-
-        in.read(reinterpret_cast<char*>(vec->data()), sizeof(std::byte) * length);
+        uint32_t count = 0;
+        const std::byte* data = ReadSpan<std::byte>(&count);
+        vec->assign(data, data + count);
     }
 }
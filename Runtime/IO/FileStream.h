@@ -51,6 +51,13 @@ namespace Spartan
         auto IsOpen() const { return m_is_open; }
         void Close();
 
+        // Absolute cursor position, for formats which store offsets to their sections
+        uint64_t GetPosition();
+        void Seek(uint64_t position);
+
+        // The size of the file (when reading)
+        uint64_t GetSize() const { return m_size; }
+
         //= WRITING ==================================================
         template <class T, class = typename std::enable_if<
             std::is_same<T, bool>::value                ||
@@ -76,7 +83,7 @@ namespace Spartan
         >::type>
         void Write(T value)
         {
-            out.write(reinterpret_cast<char*>(&value), sizeof(value));
+            WriteBytes(&value, sizeof(value));
         }
 
         void Write(const std::string& value);
@@ -114,7 +121,7 @@ namespace Spartan
         >::type>
         void Read(T* value)
         {
-            in.read(reinterpret_cast<char*>(value), sizeof(T));
+            ReadBytes(value, sizeof(T));
         }
         void Read(std::string* value);
         void Read(std::vector<std::string>* vec);
@@ -123,6 +130,28 @@ namespace Spartan
         void Read(std::vector<unsigned char>* vec);
         void Read(std::vector<std::byte>* vec);
 
+        // Zero-copy reads, the returned memory belongs to the mapped file and is valid for as long as the stream is open.
+        // A view is nullptr when the file doesn't have that many bytes left (nothing is read in that case).
+        const std::byte* ReadView(uint64_t size);
+
+        // A view of a byte array that was written by one of the vector writes above. Only for byte types, as anything wider could sit at
+        // any offset in the file (unaligned) and is not allowed to alias the mapped bytes, wider arrays are copied out by the vector reads.
+        template <class T>
+        const T* ReadSpan(uint32_t* count)
+        {
+            static_assert(sizeof(T) == 1 && (std::is_same<T, unsigned char>::value || std::is_same<T, std::byte>::value), "Only byte arrays can be viewed in place");
+
+            *count = ReadAs<uint32_t>();
+
+            const T* data = reinterpret_cast<const T*>(ReadView(static_cast<uint64_t>(*count) * sizeof(T)));
+            if (!data)
+            {
+                *count = 0;
+            }
+
+            return data;
+        }
+
         // Reading with explicit type definition
         template <class T, class = typename std::enable_if
         <
@@ -152,9 +181,24 @@ namespace Spartan
         //=====================================================
 
     private:
-        std::ofstream out;
-        std::ifstream in;
-        uint32_t m_flags;
-        bool m_is_open;
+        template <class T>
+        void ReadArray(std::vector<T>* vec);
+        void WriteBytes(const void* data, uint64_t size);
+        void WriteFlush();
+        void ReadBytes(void* data, uint64_t size);
+
+        // Writing goes through a large buffer, so that the many small writes don't each reach the OS
+        std::ofstream m_out;
+        std::vector<std::byte> m_write_buffer;
+
+        // Reading goes through a view of the whole file, mapped into memory
+        void* m_file            = nullptr;
+        void* m_file_mapping    = nullptr;
+        const std::byte* m_data = nullptr;
+        uint64_t m_size         = 0;
+        uint64_t m_position     = 0;
+
+        uint32_t m_flags    = 0;
+        bool m_is_open      = false;
     };
 }
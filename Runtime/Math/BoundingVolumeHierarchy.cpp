@@ -0,0 +1,387 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ========================
+#include "Spartan.h"
+#include "BoundingVolumeHierarchy.h"
+//===================================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+    // How much leaf boxes are enlarged by, so that small movements don't require re-insertion
+    static constexpr float margin = 0.1f;
+
+    static BoundingBox merge(const BoundingBox& a, const BoundingBox& b)
+    {
+        BoundingBox box = a;
+        box.Merge(b);
+        return box;
+    }
+
+    static float surface_area(const BoundingBox& box)
+    {
+        const Vector3 size = box.GetSize();
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    static bool contains(const BoundingBox& outer, const BoundingBox& inner)
+    {
+        return
+            outer.GetMin().x <= inner.GetMin().x && outer.GetMin().y <= inner.GetMin().y && outer.GetMin().z <= inner.GetMin().z &&
+            outer.GetMax().x >= inner.GetMax().x && outer.GetMax().y >= inner.GetMax().y && outer.GetMax().z >= inner.GetMax().z;
+    }
+
+    uint32_t BoundingVolumeHierarchy::Insert(const BoundingBox& box, void* user_data)
+    {
+        const uint32_t leaf = NodeAllocate();
+        Node& node          = m_nodes[leaf];
+        node.box_tight      = box;
+        node.box            = BoundingBox(box.GetMin() - Vector3(margin), box.GetMax() + Vector3(margin));
+        node.user_data      = user_data;
+        node.height         = 0;
+
+        LeafInsert(leaf);
+        m_leaf_count++;
+
+        return leaf;
+    }
+
+    void BoundingVolumeHierarchy::Remove(const uint32_t proxy)
+    {
+        if (proxy >= m_nodes.size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        LeafRemove(proxy);
+        NodeFree(proxy);
+        m_leaf_count--;
+    }
+
+    bool BoundingVolumeHierarchy::Update(const uint32_t proxy, const BoundingBox& box)
+    {
+        if (proxy >= m_nodes.size() || !m_nodes[proxy].IsLeaf() || m_nodes[proxy].height != 0)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        Node& node      = m_nodes[proxy];
+        node.box_tight  = box;
+
+        // Still within the loose box, nothing to restructure
+        if (contains(node.box, box))
+            return false;
+
+        LeafRemove(proxy);
+        m_nodes[proxy].box = BoundingBox(box.GetMin() - Vector3(margin), box.GetMax() + Vector3(margin));
+        LeafInsert(proxy);
+
+        return true;
+    }
+
+    void BoundingVolumeHierarchy::Clear()
+    {
+        m_nodes.clear();
+        m_root          = null_node;
+        m_free_list     = null_node;
+        m_leaf_count    = 0;
+    }
+
+    bool BoundingVolumeHierarchy::Overlaps(const BoundingBox& a, const BoundingBox& b)
+    {
+        return
+            a.GetMin().x <= b.GetMax().x && a.GetMax().x >= b.GetMin().x &&
+            a.GetMin().y <= b.GetMax().y && a.GetMax().y >= b.GetMin().y &&
+            a.GetMin().z <= b.GetMax().z && a.GetMax().z >= b.GetMin().z;
+    }
+
+    bool BoundingVolumeHierarchy::Overlaps(const BoundingBox& box, const Vector3& center, const float radius)
+    {
+        // Squared distance from the center to the closest point of the box
+        const auto axis_distance = [](const float v, const float min, const float max)
+        {
+            const float delta = v < min ? min - v : (v > max ? v - max : 0.0f);
+            return delta * delta;
+        };
+
+        const float distance_squared =
+            axis_distance(center.x, box.GetMin().x, box.GetMax().x) +
+            axis_distance(center.y, box.GetMin().y, box.GetMax().y) +
+            axis_distance(center.z, box.GetMin().z, box.GetMax().z);
+
+        return distance_squared <= radius * radius;
+    }
+
+    uint32_t BoundingVolumeHierarchy::NodeAllocate()
+    {
+        if (m_free_list == null_node)
+        {
+            m_nodes.emplace_back();
+            return static_cast<uint32_t>(m_nodes.size() - 1);
+        }
+
+        const uint32_t index    = m_free_list;
+        m_free_list             = m_nodes[index].parent;
+        m_nodes[index]          = Node();
+
+        return index;
+    }
+
+    void BoundingVolumeHierarchy::NodeFree(const uint32_t index)
+    {
+        m_nodes[index]          = Node();
+        m_nodes[index].parent   = m_free_list;
+        m_free_list             = index;
+    }
+
+    void BoundingVolumeHierarchy::LeafInsert(const uint32_t leaf)
+    {
+        if (m_root == null_node)
+        {
+            m_root                  = leaf;
+            m_nodes[leaf].parent    = null_node;
+            return;
+        }
+
+        // Descend towards the sibling which results in the least surface area (the cost of every node that has to grow is inherited)
+        const BoundingBox box_leaf = m_nodes[leaf].box;
+        uint32_t index = m_root;
+        while (!m_nodes[index].IsLeaf())
+        {
+            const Node& node            = m_nodes[index];
+            const float area            = surface_area(node.box);
+            const float area_combined   = surface_area(merge(node.box, box_leaf));
+
+            // Cost of making a new parent for this node and the leaf
+            const float cost = 2.0f * area_combined;
+
+            // Minimum cost of pushing the leaf further down
+            const float cost_inheritance = 2.0f * (area_combined - area);
+
+            const auto cost_child = [this, &box_leaf, cost_inheritance](const uint32_t child)
+            {
+                const Node& node_child  = m_nodes[child];
+                const float area_merged = surface_area(merge(box_leaf, node_child.box));
+                return (node_child.IsLeaf() ? area_merged : area_merged - surface_area(node_child.box)) + cost_inheritance;
+            };
+
+            const float cost_left   = cost_child(node.child_left);
+            const float cost_right  = cost_child(node.child_right);
+
+            if (cost < cost_left && cost < cost_right)
+                break;
+
+            index = cost_left < cost_right ? node.child_left : node.child_right;
+        }
+
+        // Create a new parent for the sibling and the leaf
+        const uint32_t sibling      = index;
+        const uint32_t parent_old   = m_nodes[sibling].parent;
+        const uint32_t parent_new   = NodeAllocate();
+        {
+            Node& node          = m_nodes[parent_new];
+            node.parent         = parent_old;
+            node.box            = merge(box_leaf, m_nodes[sibling].box);
+            node.height         = m_nodes[sibling].height + 1;
+            node.child_left     = sibling;
+            node.child_right    = leaf;
+        }
+        m_nodes[sibling].parent = parent_new;
+        m_nodes[leaf].parent    = parent_new;
+
+        if (parent_old != null_node)
+        {
+            Node& node = m_nodes[parent_old];
+            (node.child_left == sibling ? node.child_left : node.child_right) = parent_new;
+        }
+        else
+        {
+            m_root = parent_new;
+        }
+
+        // Walk back up, fixing heights and boxes
+        Refit(parent_new);
+    }
+
+    void BoundingVolumeHierarchy::LeafRemove(const uint32_t leaf)
+    {
+        if (leaf == m_root)
+        {
+            m_root = null_node;
+            return;
+        }
+
+        const uint32_t parent       = m_nodes[leaf].parent;
+        const uint32_t grandparent  = m_nodes[parent].parent;
+        const uint32_t sibling      = m_nodes[parent].child_left == leaf ? m_nodes[parent].child_right : m_nodes[parent].child_left;
+
+        // The sibling takes the place of the parent
+        m_nodes[sibling].parent = grandparent;
+        NodeFree(parent);
+
+        if (grandparent != null_node)
+        {
+            Node& node = m_nodes[grandparent];
+            (node.child_left == parent ? node.child_left : node.child_right) = sibling;
+            Refit(grandparent);
+        }
+        else
+        {
+            m_root = sibling;
+        }
+    }
+
+    void BoundingVolumeHierarchy::Refit(uint32_t index)
+    {
+        while (index != null_node)
+        {
+            index = Balance(index);
+
+            Node& node      = m_nodes[index];
+            const Node& l   = m_nodes[node.child_left];
+            const Node& r   = m_nodes[node.child_right];
+            node.height     = 1 + Helper::Max(l.height, r.height);
+            node.box        = merge(l.box, r.box);
+
+            index = node.parent;
+        }
+    }
+
+    uint32_t BoundingVolumeHierarchy::Balance(const uint32_t index_a)
+    {
+        // Performs a left or right rotation if node A is imbalanced, returns the new root of the subtree
+        Node& a = m_nodes[index_a];
+        if (a.IsLeaf() || a.height < 2)
+            return index_a;
+
+        const uint32_t index_b  = a.child_left;
+        const uint32_t index_c  = a.child_right;
+        Node& b                 = m_nodes[index_b];
+        Node& c                 = m_nodes[index_c];
+        const int32_t balance   = c.height - b.height;
+
+        // Rotate C up
+        if (balance > 1)
+        {
+            const uint32_t index_f  = c.child_left;
+            const uint32_t index_g  = c.child_right;
+            Node& f                 = m_nodes[index_f];
+            Node& g                 = m_nodes[index_g];
+
+            // Swap A and C
+            c.child_left    = index_a;
+            c.parent        = a.parent;
+            a.parent        = index_c;
+
+            // A's old parent should point to C
+            if (c.parent != null_node)
+            {
+                Node& parent = m_nodes[c.parent];
+                (parent.child_left == index_a ? parent.child_left : parent.child_right) = index_c;
+            }
+            else
+            {
+                m_root = index_c;
+            }
+
+            // Rotate
+            if (f.height > g.height)
+            {
+                c.child_right   = index_f;
+                a.child_right   = index_g;
+                g.parent        = index_a;
+                a.box           = merge(b.box, g.box);
+                c.box           = merge(a.box, f.box);
+                a.height        = 1 + Helper::Max(b.height, g.height);
+                c.height        = 1 + Helper::Max(a.height, f.height);
+            }
+            else
+            {
+                c.child_right   = index_g;
+                a.child_right   = index_f;
+                f.parent        = index_a;
+                a.box           = merge(b.box, f.box);
+                c.box           = merge(a.box, g.box);
+                a.height        = 1 + Helper::Max(b.height, f.height);
+                c.height        = 1 + Helper::Max(a.height, g.height);
+            }
+
+            return index_c;
+        }
+
+        // Rotate B up
+        if (balance < -1)
+        {
+            const uint32_t index_d  = b.child_left;
+            const uint32_t index_e  = b.child_right;
+            Node& d                 = m_nodes[index_d];
+            Node& e                 = m_nodes[index_e];
+
+            // Swap A and B
+            b.child_left    = index_a;
+            b.parent        = a.parent;
+            a.parent        = index_b;
+
+            // A's old parent should point to B
+            if (b.parent != null_node)
+            {
+                Node& parent = m_nodes[b.parent];
+                (parent.child_left == index_a ? parent.child_left : parent.child_right) = index_b;
+            }
+            else
+            {
+                m_root = index_b;
+            }
+
+            // Rotate
+            if (d.height > e.height)
+            {
+                b.child_right   = index_d;
+                a.child_left    = index_e;
+                e.parent        = index_a;
+                a.box           = merge(c.box, e.box);
+                b.box           = merge(a.box, d.box);
+                a.height        = 1 + Helper::Max(c.height, e.height);
+                b.height        = 1 + Helper::Max(a.height, d.height);
+            }
+            else
+            {
+                b.child_right   = index_e;
+                a.child_left    = index_d;
+                d.parent        = index_a;
+                a.box           = merge(c.box, d.box);
+                b.box           = merge(a.box, e.box);
+                a.height        = 1 + Helper::Max(c.height, d.height);
+                b.height        = 1 + Helper::Max(a.height, e.height);
+            }
+
+            return index_b;
+        }
+
+        return index_a;
+    }
+}
@@ -0,0 +1,192 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===========================
+#include <vector>
+#include "BoundingBox.h"
+#include "Frustum.h"
+#include "Ray.h"
+#include "../Core/Spartan_Definitions.h"
+//======================================
+
+namespace Spartan::Math
+{
+    // A dynamic bounding volume hierarchy (an AABB tree). Leaves store a loose ("fat") box, so small movements don't
+    // change the tree, and bigger ones re-insert just that leaf. Insertions pick the sibling which adds the least surface
+    // area and rotations keep the tree balanced, so all queries are logarithmic in the number of leaves.
+    class SPARTAN_CLASS BoundingVolumeHierarchy
+    {
+    public:
+        static constexpr uint32_t null_node = 0xFFFFFFFF;
+
+        BoundingVolumeHierarchy() = default;
+        ~BoundingVolumeHierarchy() = default;
+
+        // Adds a leaf and returns its proxy
+        uint32_t Insert(const BoundingBox& box, void* user_data);
+        // Removes a leaf
+        void Remove(uint32_t proxy);
+        // Updates the box of a leaf, returns true if the leaf had to be moved within the tree
+        bool Update(uint32_t proxy, const BoundingBox& box);
+        // Removes all leaves
+        void Clear();
+
+        void* GetUserData(uint32_t proxy)           const { return m_nodes[proxy].user_data; }
+        const BoundingBox& GetBox(uint32_t proxy)   const { return m_nodes[proxy].box_tight; }
+        uint32_t GetLeafCount()                     const { return m_leaf_count; }
+        uint32_t GetHeight()                        const { return m_root != null_node ? m_nodes[m_root].height : 0; }
+
+        // Invokes callback(user_data) for every leaf whose box overlaps the given box
+        template <typename Callback>
+        void Query(const BoundingBox& box, Callback&& callback) const
+        {
+            Traverse(
+                [&box](const BoundingBox& node_box)             { return Overlaps(node_box, box) ? Intersects : Outside; },
+                [&box, &callback](const Node& leaf, bool)       { if (Overlaps(leaf.box_tight, box)) callback(leaf.user_data); }
+            );
+        }
+
+        // Invokes callback(user_data) for every leaf whose box overlaps the given sphere
+        template <typename Callback>
+        void Query(const Vector3& center, const float radius, Callback&& callback) const
+        {
+            Traverse(
+                [&center, radius](const BoundingBox& node_box)              { return Overlaps(node_box, center, radius) ? Intersects : Outside; },
+                [&center, radius, &callback](const Node& leaf, bool)        { if (Overlaps(leaf.box_tight, center, radius)) callback(leaf.user_data); }
+            );
+        }
+
+        // Invokes callback(user_data, distance) for every leaf whose box is hit by the ray
+        template <typename Callback>
+        void Query(const Ray& ray, Callback&& callback) const
+        {
+            Traverse(
+                [&ray](const BoundingBox& node_box) { return ray.HitDistance(node_box) != Helper::INFINITY_ ? Intersects : Outside; },
+                [&ray, &callback](const Node& leaf, bool)
+                {
+                    const float distance = ray.HitDistance(leaf.box_tight);
+                    if (distance != Helper::INFINITY_)
+                    {
+                        callback(leaf.user_data, distance);
+                    }
+                }
+            );
+        }
+
+        // Invokes callback(user_data, box, contained) for every leaf which might be visible. Whole subtrees which are inside the frustum are
+        // accepted without further testing (contained is true), for the rest, only the loose box has been tested, so box (the tight one) can be tested by the caller.
+        template <typename Callback>
+        void Query(const Frustum& frustum, const bool ignore_near_plane, Callback&& callback) const
+        {
+            Traverse(
+                [&frustum, ignore_near_plane](const BoundingBox& node_box)  { return frustum.CheckCube(node_box.GetCenter(), node_box.GetExtents(), ignore_near_plane); },
+                [&callback](const Node& leaf, const bool contained)         { callback(leaf.user_data, leaf.box_tight, contained); }
+            );
+        }
+
+    private:
+        struct Node
+        {
+            bool IsLeaf() const { return child_left == null_node; }
+
+            BoundingBox box;        // loose for leaves, the union of the children for the rest
+            BoundingBox box_tight;  // leaves only
+            void* user_data         = nullptr;
+            uint32_t parent         = null_node; // the next free node, when in the free list
+            uint32_t child_left     = null_node;
+            uint32_t child_right    = null_node;
+            int32_t height          = -1;        // leaves are 0, free nodes are -1
+        };
+
+        // Walks the tree, classify(box) decides whether to descend, visit(leaf, contained) gets the leaves
+        template <typename Classify, typename Visit>
+        void Traverse(Classify&& classify, Visit&& visit) const
+        {
+            if (m_root == null_node)
+                return;
+
+            // Each entry is a node index, the top bit marks nodes which are known to be contained. The stack lives on the
+            // stack, which a balanced tree never outgrows, an unbalanced one moves it to the heap rather than skip subtrees.
+            constexpr uint32_t contained_bit    = 0x80000000;
+            uint32_t stack_local[64];
+            std::vector<uint32_t> stack_heap;
+            uint32_t* stack         = stack_local;
+            uint32_t stack_capacity = 64;
+            uint32_t stack_size     = 0;
+            stack[stack_size++]     = m_root;
+
+            while (stack_size != 0)
+            {
+                const uint32_t entry        = stack[--stack_size];
+                const uint32_t index        = entry & ~contained_bit;
+                bool contained              = (entry & contained_bit) != 0;
+                const Node& node            = m_nodes[index];
+
+                if (!contained)
+                {
+                    const Intersection result = classify(node.box);
+                    if (result == Outside)
+                        continue;
+
+                    contained = result == Inside;
+                }
+
+                if (node.IsLeaf())
+                {
+                    visit(node, contained);
+                }
+                else
+                {
+                    if (stack_size + 2 > stack_capacity)
+                    {
+                        if (stack == stack_local)
+                        {
+                            stack_heap.assign(stack_local, stack_local + stack_size);
+                        }
+                        stack_capacity *= 2;
+                        stack_heap.resize(stack_capacity);
+                        stack = stack_heap.data();
+                    }
+
+                    stack[stack_size++] = node.child_left | (contained ? contained_bit : 0);
+                    stack[stack_size++] = node.child_right | (contained ? contained_bit : 0);
+                }
+            }
+        }
+
+        static bool Overlaps(const BoundingBox& a, const BoundingBox& b);
+        static bool Overlaps(const BoundingBox& box, const Vector3& center, float radius);
+
+        uint32_t NodeAllocate();
+        void NodeFree(uint32_t index);
+        void LeafInsert(uint32_t leaf);
+        void LeafRemove(uint32_t leaf);
+        void Refit(uint32_t index);
+        uint32_t Balance(uint32_t index);
+
+        std::vector<Node> m_nodes;
+        uint32_t m_root         = null_node;
+        uint32_t m_free_list    = null_node;
+        uint32_t m_leaf_count   = 0;
+    };
+}
@@ -21,6 +21,10 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =======
 #include "Spartan.h"
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <immintrin.h>
+#define SPARTAN_FRUSTUM_SIMD
+#endif
 //==================
 
 //= NAMESPACES =====
@@ -108,15 +112,153 @@ namespace Spartan::Math
         return false;
     }
 
-    Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent) const
+    void Frustum::IsVisible(const BoundingBoxSoA& boxes, const uint32_t start, const uint32_t end, uint32_t* visibility, bool ignore_near_plane /*= false*/) const
+    {
+        if (!visibility || start > end || end > boxes.Size())
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        // The near plane is the first one
+        const uint32_t plane_start = ignore_near_plane ? 1 : 0;
+
+        // A box is outside if it's entirely behind any plane, that is, if the signed distance of its center
+        // plus its projected radius (the extent projected on the absolute plane normal) is negative.
+        const auto is_visible = [this, &boxes, plane_start](const uint32_t i)
+        {
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                const Plane& plane  = m_planes[p];
+                const float d       = boxes.center_x[i] * plane.normal.x + boxes.center_y[i] * plane.normal.y + boxes.center_z[i] * plane.normal.z + plane.d;
+                const float r       = boxes.extent_x[i] * Helper::Abs(plane.normal.x) + boxes.extent_y[i] * Helper::Abs(plane.normal.y) + boxes.extent_z[i] * Helper::Abs(plane.normal.z);
+
+                if (d + r < 0.0f)
+                    return false;
+            }
+
+            return true;
+        };
+
+        // Bits outside of [start, end) are preserved in the first and last elements
+        uint32_t i      = start;
+        uint32_t word   = (start % 32 != 0) ? visibility[start / 32] & ((1u << (start % 32)) - 1) : 0;
+        const auto write_bits = [visibility, &word](const uint32_t index, const uint32_t bits, const uint32_t bit_count)
+        {
+            word |= bits << (index % 32);
+            if ((index + bit_count) % 32 == 0)
+            {
+                visibility[index / 32] = word;
+                word = 0;
+            }
+        };
+
+        // Unaligned starts are handled one box at a time, until the next group boundary
+        while (i < end && i % 32 != 0)
+        {
+            write_bits(i, is_visible(i) ? 1 : 0, 1);
+            i++;
+        }
+
+    #if defined(SPARTAN_FRUSTUM_SIMD)
+    #if defined(__AVX__)
+        {
+            __m256 n_x[6], n_y[6], n_z[6], n_d[6], a_x[6], a_y[6], a_z[6];
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                n_x[p] = _mm256_set1_ps(m_planes[p].normal.x);
+                n_y[p] = _mm256_set1_ps(m_planes[p].normal.y);
+                n_z[p] = _mm256_set1_ps(m_planes[p].normal.z);
+                n_d[p] = _mm256_set1_ps(m_planes[p].d);
+                a_x[p] = _mm256_set1_ps(Helper::Abs(m_planes[p].normal.x));
+                a_y[p] = _mm256_set1_ps(Helper::Abs(m_planes[p].normal.y));
+                a_z[p] = _mm256_set1_ps(Helper::Abs(m_planes[p].normal.z));
+            }
+
+            const __m256 zero = _mm256_setzero_ps();
+            for (; i + 8 <= end; i += 8)
+            {
+                const __m256 c_x = _mm256_loadu_ps(&boxes.center_x[i]);
+                const __m256 c_y = _mm256_loadu_ps(&boxes.center_y[i]);
+                const __m256 c_z = _mm256_loadu_ps(&boxes.center_z[i]);
+                const __m256 e_x = _mm256_loadu_ps(&boxes.extent_x[i]);
+                const __m256 e_y = _mm256_loadu_ps(&boxes.extent_y[i]);
+                const __m256 e_z = _mm256_loadu_ps(&boxes.extent_z[i]);
+
+                __m256 outside = zero;
+                for (uint32_t p = plane_start; p < 6; p++)
+                {
+                    const __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(c_x, n_x[p]), _mm256_mul_ps(c_y, n_y[p])), _mm256_add_ps(_mm256_mul_ps(c_z, n_z[p]), n_d[p]));
+                    const __m256 r = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(e_x, a_x[p]), _mm256_mul_ps(e_y, a_y[p])), _mm256_mul_ps(e_z, a_z[p]));
+                    outside = _mm256_or_ps(outside, _mm256_cmp_ps(_mm256_add_ps(d, r), zero, _CMP_LT_OQ));
+                }
+
+                write_bits(i, static_cast<uint32_t>(~_mm256_movemask_ps(outside)) & 0xFF, 8);
+            }
+        }
+    #else
+        {
+            __m128 n_x[6], n_y[6], n_z[6], n_d[6], a_x[6], a_y[6], a_z[6];
+            for (uint32_t p = plane_start; p < 6; p++)
+            {
+                n_x[p] = _mm_set1_ps(m_planes[p].normal.x);
+                n_y[p] = _mm_set1_ps(m_planes[p].normal.y);
+                n_z[p] = _mm_set1_ps(m_planes[p].normal.z);
+                n_d[p] = _mm_set1_ps(m_planes[p].d);
+                a_x[p] = _mm_set1_ps(Helper::Abs(m_planes[p].normal.x));
+                a_y[p] = _mm_set1_ps(Helper::Abs(m_planes[p].normal.y));
+                a_z[p] = _mm_set1_ps(Helper::Abs(m_planes[p].normal.z));
+            }
+
+            const __m128 zero = _mm_setzero_ps();
+            for (; i + 4 <= end; i += 4)
+            {
+                const __m128 c_x = _mm_loadu_ps(&boxes.center_x[i]);
+                const __m128 c_y = _mm_loadu_ps(&boxes.center_y[i]);
+                const __m128 c_z = _mm_loadu_ps(&boxes.center_z[i]);
+                const __m128 e_x = _mm_loadu_ps(&boxes.extent_x[i]);
+                const __m128 e_y = _mm_loadu_ps(&boxes.extent_y[i]);
+                const __m128 e_z = _mm_loadu_ps(&boxes.extent_z[i]);
+
+                __m128 outside = zero;
+                for (uint32_t p = plane_start; p < 6; p++)
+                {
+                    const __m128 d = _mm_add_ps(_mm_add_ps(_mm_mul_ps(c_x, n_x[p]), _mm_mul_ps(c_y, n_y[p])), _mm_add_ps(_mm_mul_ps(c_z, n_z[p]), n_d[p]));
+                    const __m128 r = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e_x, a_x[p]), _mm_mul_ps(e_y, a_y[p])), _mm_mul_ps(e_z, a_z[p]));
+                    outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(d, r), zero));
+                }
+
+                write_bits(i, static_cast<uint32_t>(~_mm_movemask_ps(outside)) & 0xF, 4);
+            }
+        }
+    #endif
+    #endif
+
+        // Remaining boxes
+        for (; i < end; i++)
+        {
+            write_bits(i, is_visible(i) ? 1 : 0, 1);
+        }
+
+        // Flush the last partial element
+        if (end % 32 != 0 && end > start)
+        {
+            const uint32_t mask_written = (1u << (end % 32)) - 1;
+            visibility[end / 32] = (visibility[end / 32] & ~mask_written) | word;
+        }
+    }
+
+    Intersection Frustum::CheckCube(const Vector3& center, const Vector3& extent, bool ignore_near_plane /*= false*/) const
     {
         Intersection result = Inside;
         Plane plane_abs;
 
         // Check if any one point of the cube is in the view frustum.
         
-        for (const Plane& plane : m_planes)
+        for (uint32_t i = ignore_near_plane ? 1 : 0; i < 6; i++)
         {
+            const Plane& plane = m_planes[i];
+
             plane_abs.normal    = plane.normal.Abs();
             plane_abs.d         = plane.d;
 
@@ -22,6 +22,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #pragma once
 
 //= INCLUDES =============
+#include <vector>
 #include "../Math/Plane.h"
 #include "Matrix.h"
 #include "Vector3.h"
@@ -29,6 +30,37 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 namespace Spartan::Math
 {
+    // Bounding boxes (center and extent) laid out as a structure of arrays, which is what batch culling works with
+    struct BoundingBoxSoA
+    {
+        void Resize(const uint32_t count)
+        {
+            center_x.resize(count); center_y.resize(count); center_z.resize(count);
+            extent_x.resize(count); extent_y.resize(count); extent_z.resize(count);
+        }
+
+        void Set(const uint32_t index, const Vector3& center, const Vector3& extent)
+        {
+            center_x[index] = center.x; center_y[index] = center.y; center_z[index] = center.z;
+            extent_x[index] = extent.x; extent_y[index] = extent.y; extent_z[index] = extent.z;
+        }
+
+        void Add(const Vector3& center, const Vector3& extent)
+        {
+            center_x.emplace_back(center.x); center_y.emplace_back(center.y); center_z.emplace_back(center.z);
+            extent_x.emplace_back(extent.x); extent_y.emplace_back(extent.y); extent_z.emplace_back(extent.z);
+        }
+
+        uint32_t Size() const { return static_cast<uint32_t>(center_x.size()); }
+
+        std::vector<float> center_x;
+        std::vector<float> center_y;
+        std::vector<float> center_z;
+        std::vector<float> extent_x;
+        std::vector<float> extent_y;
+        std::vector<float> extent_z;
+    };
+
     class Frustum
     {
     public:
@@ -38,8 +70,15 @@ namespace Spartan::Math
 
         bool IsVisible(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
 
+        // Tests the boxes in [start, end) and writes a bit per box (1 = visible) to visibility, where box i maps to bit i % 32 of element i / 32.
+        // Four boxes (eight with AVX) are tested against all planes at once. Whole elements are written, so when splitting a batch across
+        // threads, start should be a multiple of 32. Unlike IsVisible(), this is an exact box test, it doesn't approximate with a sphere.
+        void IsVisible(const BoundingBoxSoA& boxes, uint32_t start, uint32_t end, uint32_t* visibility, bool ignore_near_plane = false) const;
+
+        // Exact box test, tells apart boxes which are entirely inside from the ones which intersect the frustum
+        Intersection CheckCube(const Vector3& center, const Vector3& extent, bool ignore_near_plane = false) const;
+
     private:
-        Intersection CheckCube(const Vector3& center, const Vector3& extent) const;
         Intersection CheckSphere(const Vector3& center, float radius) const;
 
         Plane m_planes[6];
@@ -0,0 +1,428 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES =======
+#include "Spartan.h"
+#include "TriangleBvh.h"
+#if defined(_M_X64) || defined(__x86_64__) || defined(__SSE2__)
+#include <immintrin.h>
+#define SPARTAN_TRIANGLE_BVH_SIMD
+#endif
+//==================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan::Math
+{
+    static constexpr uint32_t bin_count         = 16;
+    // Past this depth splits are made at the median, which bounds the traversal stack
+    static constexpr uint32_t sah_depth_max     = 64;
+    static constexpr uint32_t stack_size        = 128;
+
+    struct Bounds
+    {
+        Vector3 min = Vector3::Infinity;
+        Vector3 max = Vector3::InfinityNeg;
+
+        void Merge(const Vector3& point_min, const Vector3& point_max)
+        {
+            min = Vector3(Helper::Min(min.x, point_min.x), Helper::Min(min.y, point_min.y), Helper::Min(min.z, point_min.z));
+            max = Vector3(Helper::Max(max.x, point_max.x), Helper::Max(max.y, point_max.y), Helper::Max(max.z, point_max.z));
+        }
+        void Merge(const Vector3& point)    { Merge(point, point); }
+        void Merge(const Bounds& other)     { Merge(other.min, other.max); }
+
+        float SurfaceArea() const
+        {
+            if (min.x > max.x)
+                return 0.0f;
+
+            const Vector3 size = max - min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+    };
+
+    static float axis_of(const Vector3& v, const uint32_t axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    void TriangleBvh::Build(const float* positions, const uint32_t position_stride, const uint32_t position_count, const uint32_t* indices, const uint32_t index_count)
+    {
+        Clear();
+
+        if (!positions || !indices || position_stride < sizeof(float) * 3 || index_count < 3)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const auto position = [positions, position_stride](const uint32_t index)
+        {
+            const float* p = reinterpret_cast<const float*>(reinterpret_cast<const uint8_t*>(positions) + static_cast<size_t>(index) * position_stride);
+            return Vector3(p[0], p[1], p[2]);
+        };
+
+        // Per triangle bounds and centroids, triangles which reference missing vertices are dropped
+        vector<Bounds> triangle_bounds;
+        vector<Vector3> triangle_centroids;
+        vector<uint32_t> triangles;
+        triangle_bounds.reserve(index_count / 3);
+        triangle_centroids.reserve(index_count / 3);
+        triangles.reserve(index_count / 3);
+        for (uint32_t i = 0; i + 2 < index_count; i += 3)
+        {
+            if (indices[i] >= position_count || indices[i + 1] >= position_count || indices[i + 2] >= position_count)
+                continue;
+
+            Bounds bounds;
+            bounds.Merge(position(indices[i]));
+            bounds.Merge(position(indices[i + 1]));
+            bounds.Merge(position(indices[i + 2]));
+
+            triangles.emplace_back(i / 3);
+            triangle_centroids.emplace_back((bounds.min + bounds.max) * 0.5f);
+            triangle_bounds.emplace_back(bounds);
+        }
+
+        if (triangles.size() != index_count / 3)
+        {
+            LOG_WARNING("%d triangles reference vertices which don't exist, they will be ignored", static_cast<int>(index_count / 3 - triangles.size()));
+        }
+
+        m_triangle_count = static_cast<uint32_t>(triangles.size());
+        if (m_triangle_count == 0)
+            return;
+
+        // The position in the triangles array is what gets partitioned, so map it back to the bounds
+        vector<uint32_t> order(m_triangle_count);
+        for (uint32_t i = 0; i < m_triangle_count; i++)
+        {
+            order[i] = i;
+        }
+
+        m_nodes.reserve((m_triangle_count / leaf_size) * 2 + 1);
+        m_leaves.reserve(m_triangle_count / leaf_size + 1);
+        m_nodes.emplace_back();
+
+        struct Item { uint32_t node; uint32_t begin; uint32_t end; uint32_t depth; };
+        vector<Item> items;
+        items.push_back({ 0, 0, m_triangle_count, 0 });
+        while (!items.empty())
+        {
+            const Item item = items.back();
+            items.pop_back();
+
+            Bounds bounds;
+            Bounds bounds_centroid;
+            for (uint32_t i = item.begin; i < item.end; i++)
+            {
+                bounds.Merge(triangle_bounds[order[i]]);
+                bounds_centroid.Merge(triangle_centroids[order[i]]);
+            }
+
+            Node& node  = m_nodes[item.node];
+            node.min[0] = bounds.min.x; node.min[1] = bounds.min.y; node.min[2] = bounds.min.z;
+            node.max[0] = bounds.max.x; node.max[1] = bounds.max.y; node.max[2] = bounds.max.z;
+
+            const uint32_t count = item.end - item.begin;
+            if (count <= leaf_size)
+            {
+                Leaf leaf = {};
+                for (uint32_t lane = 0; lane < count; lane++)
+                {
+                    const uint32_t triangle = triangles[order[item.begin + lane]];
+                    const Vector3 v0        = position(indices[triangle * 3]);
+                    const Vector3 e1        = position(indices[triangle * 3 + 1]) - v0;
+                    const Vector3 e2        = position(indices[triangle * 3 + 2]) - v0;
+
+                    leaf.v0_x[lane] = v0.x; leaf.v0_y[lane] = v0.y; leaf.v0_z[lane] = v0.z;
+                    leaf.e1_x[lane] = e1.x; leaf.e1_y[lane] = e1.y; leaf.e1_z[lane] = e1.z;
+                    leaf.e2_x[lane] = e2.x; leaf.e2_y[lane] = e2.y; leaf.e2_z[lane] = e2.z;
+                    leaf.triangle[lane] = triangle;
+                }
+
+                node.first = static_cast<uint32_t>(m_leaves.size());
+                node.count = count;
+                m_leaves.emplace_back(leaf);
+                continue;
+            }
+
+            // Binned surface area heuristic, across all three axes
+            uint32_t split_axis = 3;
+            uint32_t split_bin  = 0;
+            if (item.depth < sah_depth_max)
+            {
+                float cost_best = numeric_limits<float>::max();
+                for (uint32_t axis = 0; axis < 3; axis++)
+                {
+                    const float axis_min = axis_of(bounds_centroid.min, axis);
+                    const float extent   = axis_of(bounds_centroid.max, axis) - axis_min;
+                    if (extent <= 0.0f)
+                        continue;
+
+                    Bounds bin_bounds[bin_count];
+                    uint32_t bin_triangles[bin_count] = {};
+                    const float scale = bin_count / extent;
+                    for (uint32_t i = item.begin; i < item.end; i++)
+                    {
+                        const uint32_t bin = Helper::Min(static_cast<uint32_t>((axis_of(triangle_centroids[order[i]], axis) - axis_min) * scale), bin_count - 1);
+                        bin_bounds[bin].Merge(triangle_bounds[order[i]]);
+                        bin_triangles[bin]++;
+                    }
+
+                    // Sweep from the right to get the cost of every right side, then from the left to evaluate each split
+                    float area_right[bin_count];
+                    uint32_t count_right[bin_count];
+                    Bounds accumulated;
+                    uint32_t accumulated_count = 0;
+                    for (uint32_t bin = bin_count - 1; bin > 0; bin--)
+                    {
+                        accumulated.Merge(bin_bounds[bin]);
+                        accumulated_count += bin_triangles[bin];
+                        area_right[bin]     = accumulated.SurfaceArea();
+                        count_right[bin]    = accumulated_count;
+                    }
+
+                    accumulated         = Bounds();
+                    accumulated_count   = 0;
+                    for (uint32_t bin = 1; bin < bin_count; bin++)
+                    {
+                        accumulated.Merge(bin_bounds[bin - 1]);
+                        accumulated_count += bin_triangles[bin - 1];
+                        if (accumulated_count == 0 || count_right[bin] == 0)
+                            continue;
+
+                        const float cost = accumulated_count * accumulated.SurfaceArea() + count_right[bin] * area_right[bin];
+                        if (cost < cost_best)
+                        {
+                            cost_best   = cost;
+                            split_axis  = axis;
+                            split_bin   = bin;
+                        }
+                    }
+                }
+            }
+
+            uint32_t middle = item.begin;
+            if (split_axis < 3)
+            {
+                const float axis_min = axis_of(bounds_centroid.min, split_axis);
+                const float scale    = bin_count / (axis_of(bounds_centroid.max, split_axis) - axis_min);
+                middle = static_cast<uint32_t>(partition(order.begin() + item.begin, order.begin() + item.end, [&](const uint32_t i)
+                {
+                    return Helper::Min(static_cast<uint32_t>((axis_of(triangle_centroids[i], split_axis) - axis_min) * scale), bin_count - 1) < split_bin;
+                }) - order.begin());
+            }
+
+            // No useful split (or too deep), split at the median of the longest axis
+            if (middle == item.begin || middle == item.end)
+            {
+                const Vector3 extent    = bounds_centroid.max - bounds_centroid.min;
+                const uint32_t axis     = extent.x >= extent.y && extent.x >= extent.z ? 0 : (extent.y >= extent.z ? 1 : 2);
+                middle                  = item.begin + count / 2;
+                nth_element(order.begin() + item.begin, order.begin() + middle, order.begin() + item.end, [&](const uint32_t a, const uint32_t b)
+                {
+                    return axis_of(triangle_centroids[a], axis) < axis_of(triangle_centroids[b], axis);
+                });
+            }
+
+            const uint32_t child_left = static_cast<uint32_t>(m_nodes.size());
+            m_nodes[item.node].first = child_left;
+            m_nodes[item.node].count = 0;
+            m_nodes.emplace_back();
+            m_nodes.emplace_back();
+
+            items.push_back({ child_left + 1, middle, item.end, item.depth + 1 });
+            items.push_back({ child_left, item.begin, middle, item.depth + 1 });
+        }
+    }
+
+    void TriangleBvh::Clear()
+    {
+        m_nodes.clear();
+        m_nodes.shrink_to_fit();
+        m_leaves.clear();
+        m_leaves.shrink_to_fit();
+        m_triangle_count = 0;
+    }
+
+    float TriangleBvh::HitDistance(const Ray& ray, uint32_t* out_triangle /*= nullptr*/) const
+    {
+        if (m_nodes.empty())
+            return Helper::INFINITY_;
+
+        const Vector3& origin       = ray.GetStart();
+        const Vector3& direction    = ray.GetDirection();
+
+        // Zero components are nudged so that the slab test never computes 0 * infinity
+        const auto inverse = [](const float x) { return 1.0f / (Helper::Abs(x) > 1e-20f ? x : 1e-20f); };
+        const Vector3 direction_inv = Vector3(inverse(direction.x), inverse(direction.y), inverse(direction.z));
+
+        float distance_min      = Helper::INFINITY_;
+        uint32_t triangle_min   = 0;
+
+        // Returns the entry distance of the node, or infinity if it's missed or further than the closest hit
+        const auto hit_node = [&origin, &direction_inv, &distance_min](const Node& node)
+        {
+            float t_min = 0.0f;
+            float t_max = distance_min;
+            const float o[3]    = { origin.x, origin.y, origin.z };
+            const float inv[3]  = { direction_inv.x, direction_inv.y, direction_inv.z };
+            for (uint32_t axis = 0; axis < 3; axis++)
+            {
+                const float t1 = (node.min[axis] - o[axis]) * inv[axis];
+                const float t2 = (node.max[axis] - o[axis]) * inv[axis];
+                t_min = Helper::Max(t_min, Helper::Min(t1, t2));
+                t_max = Helper::Min(t_max, Helper::Max(t1, t2));
+            }
+
+            return t_min <= t_max ? t_min : Helper::INFINITY_;
+        };
+
+        const auto hit_leaf = [&origin, &direction, &distance_min, &triangle_min](const Leaf& leaf, const uint32_t count)
+        {
+        #if defined(SPARTAN_TRIANGLE_BVH_SIMD)
+            // Möller-Trumbore (with back face culling, like Ray::HitDistance) against four triangles at once
+            const __m128 d_x    = _mm_set1_ps(direction.x), d_y = _mm_set1_ps(direction.y), d_z = _mm_set1_ps(direction.z);
+            const __m128 e1_x   = _mm_loadu_ps(leaf.e1_x), e1_y = _mm_loadu_ps(leaf.e1_y), e1_z = _mm_loadu_ps(leaf.e1_z);
+            const __m128 e2_x   = _mm_loadu_ps(leaf.e2_x), e2_y = _mm_loadu_ps(leaf.e2_y), e2_z = _mm_loadu_ps(leaf.e2_z);
+            const __m128 t_x    = _mm_sub_ps(_mm_set1_ps(origin.x), _mm_loadu_ps(leaf.v0_x));
+            const __m128 t_y    = _mm_sub_ps(_mm_set1_ps(origin.y), _mm_loadu_ps(leaf.v0_y));
+            const __m128 t_z    = _mm_sub_ps(_mm_set1_ps(origin.z), _mm_loadu_ps(leaf.v0_z));
+
+            // p = d x e2, det = e1 . p, u = t . p
+            const __m128 p_x    = _mm_sub_ps(_mm_mul_ps(d_y, e2_z), _mm_mul_ps(d_z, e2_y));
+            const __m128 p_y    = _mm_sub_ps(_mm_mul_ps(d_z, e2_x), _mm_mul_ps(d_x, e2_z));
+            const __m128 p_z    = _mm_sub_ps(_mm_mul_ps(d_x, e2_y), _mm_mul_ps(d_y, e2_x));
+            const __m128 det    = _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1_x, p_x), _mm_mul_ps(e1_y, p_y)), _mm_mul_ps(e1_z, p_z));
+            const __m128 u      = _mm_add_ps(_mm_add_ps(_mm_mul_ps(t_x, p_x), _mm_mul_ps(t_y, p_y)), _mm_mul_ps(t_z, p_z));
+
+            // q = t x e1, v = d . q, distance = (e2 . q) / det
+            const __m128 q_x    = _mm_sub_ps(_mm_mul_ps(t_y, e1_z), _mm_mul_ps(t_z, e1_y));
+            const __m128 q_y    = _mm_sub_ps(_mm_mul_ps(t_z, e1_x), _mm_mul_ps(t_x, e1_z));
+            const __m128 q_z    = _mm_sub_ps(_mm_mul_ps(t_x, e1_y), _mm_mul_ps(t_y, e1_x));
+            const __m128 v      = _mm_add_ps(_mm_add_ps(_mm_mul_ps(d_x, q_x), _mm_mul_ps(d_y, q_y)), _mm_mul_ps(d_z, q_z));
+            const __m128 dist   = _mm_div_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(e2_x, q_x), _mm_mul_ps(e2_y, q_y)), _mm_mul_ps(e2_z, q_z)), det);
+
+            const __m128 zero   = _mm_setzero_ps();
+            __m128 hit          = _mm_cmpge_ps(det, _mm_set1_ps(Helper::EPSILON));
+            hit                 = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+            hit                 = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+            hit                 = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), det));
+            hit                 = _mm_and_ps(hit, _mm_cmpge_ps(dist, zero));
+            hit                 = _mm_and_ps(hit, _mm_cmplt_ps(dist, _mm_set1_ps(distance_min)));
+
+            int mask = _mm_movemask_ps(hit);
+            if (mask == 0)
+                return;
+
+            float distances[leaf_size];
+            _mm_storeu_ps(distances, dist);
+            for (uint32_t lane = 0; lane < count; lane++)
+            {
+                if ((mask & (1 << lane)) && distances[lane] < distance_min)
+                {
+                    distance_min = distances[lane];
+                    triangle_min = leaf.triangle[lane];
+                }
+            }
+        #else
+            for (uint32_t lane = 0; lane < count; lane++)
+            {
+                const Vector3 v0(leaf.v0_x[lane], leaf.v0_y[lane], leaf.v0_z[lane]);
+                const Vector3 e1(leaf.e1_x[lane], leaf.e1_y[lane], leaf.e1_z[lane]);
+                const Vector3 e2(leaf.e2_x[lane], leaf.e2_y[lane], leaf.e2_z[lane]);
+
+                const Vector3 p = direction.Cross(e2);
+                const float det = e1.Dot(p);
+                if (det < Helper::EPSILON)
+                    continue;
+
+                const Vector3 t = origin - v0;
+                const float u   = t.Dot(p);
+                if (u < 0.0f || u > det)
+                    continue;
+
+                const Vector3 q = t.Cross(e1);
+                const float v   = direction.Dot(q);
+                if (v < 0.0f || u + v > det)
+                    continue;
+
+                const float distance = e2.Dot(q) / det;
+                if (distance >= 0.0f && distance < distance_min)
+                {
+                    distance_min = distance;
+                    triangle_min = leaf.triangle[lane];
+                }
+            }
+        #endif
+        };
+
+        // Front to back traversal, nodes further than the closest hit so far are skipped
+        uint32_t stack[stack_size];
+        uint32_t stack_count = 0;
+        if (hit_node(m_nodes[0]) != Helper::INFINITY_)
+        {
+            stack[stack_count++] = 0;
+        }
+
+        while (stack_count != 0)
+        {
+            const Node& node = m_nodes[stack[--stack_count]];
+
+            if (node.count != 0)
+            {
+                hit_leaf(m_leaves[node.first], node.count);
+                continue;
+            }
+
+            uint32_t near_index     = node.first;
+            uint32_t far_index      = node.first + 1;
+            float near_distance     = hit_node(m_nodes[near_index]);
+            float far_distance      = hit_node(m_nodes[far_index]);
+            if (far_distance < near_distance)
+            {
+                swap(near_index, far_index);
+                swap(near_distance, far_distance);
+            }
+
+            if (far_distance != Helper::INFINITY_)
+            {
+                stack[stack_count++] = far_index;
+            }
+
+            if (near_distance != Helper::INFINITY_)
+            {
+                stack[stack_count++] = near_index;
+            }
+        }
+
+        if (out_triangle && distance_min != Helper::INFINITY_)
+        {
+            *out_triangle = triangle_min;
+        }
+
+        return distance_min;
+    }
+}
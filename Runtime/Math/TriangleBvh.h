@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===========================
+#include <vector>
+#include "Ray.h"
+#include "../Core/Spartan_Definitions.h"
+//======================================
+
+namespace Spartan::Math
+{
+    // A static bounding volume hierarchy over the triangles of a mesh, built once with the surface area heuristic.
+    // Leaves hold up to four triangles, laid out so that a ray can be tested against all of them at once.
+    class SPARTAN_CLASS TriangleBvh
+    {
+    public:
+        static constexpr uint32_t leaf_size = 4;
+
+        TriangleBvh() = default;
+        ~TriangleBvh() = default;
+
+        // Builds the tree, positions are read with the given stride (in bytes) and indices are relative to the first position
+        void Build(const float* positions, uint32_t position_stride, uint32_t position_count, const uint32_t* indices, uint32_t index_count);
+        void Clear();
+
+        // Returns the distance (along the ray's direction) to the closest front facing triangle, or infinity if there is no hit
+        float HitDistance(const Ray& ray, uint32_t* out_triangle = nullptr) const;
+
+        bool IsBuilt()                  const { return !m_nodes.empty(); }
+        uint32_t GetTriangleCount()     const { return m_triangle_count; }
+        uint32_t GetNodeCount()         const { return static_cast<uint32_t>(m_nodes.size()); }
+        uint64_t GetMemoryUsage()       const { return m_nodes.size() * sizeof(Node) + m_leaves.size() * sizeof(Leaf); }
+
+    private:
+        struct Node
+        {
+            float min[3];
+            uint32_t first;     // interior: index of the left child (the right one follows it), leaf: index into m_leaves
+            float max[3];
+            uint32_t count;     // zero for interior nodes
+        };
+
+        // Four triangles as a vertex and two edges, in structure of arrays form (unused lanes are degenerate)
+        struct Leaf
+        {
+            float v0_x[leaf_size], v0_y[leaf_size], v0_z[leaf_size];
+            float e1_x[leaf_size], e1_y[leaf_size], e1_z[leaf_size];
+            float e2_x[leaf_size], e2_y[leaf_size], e2_z[leaf_size];
+            uint32_t triangle[leaf_size];
+        };
+
+        std::vector<Node> m_nodes;
+        std::vector<Leaf> m_leaves;
+        uint32_t m_triangle_count = 0;
+    };
+}
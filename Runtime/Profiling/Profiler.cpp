@@ -329,6 +329,7 @@ namespace Spartan
             // Renderer
             "Resolution:\t\t%dx%d\n"
             "Meshes rendered:\t%d\n"
+            "Draw calls:\t\t%d\n"
             "Textures:\t\t\t%d\n"
             "Materials:\t\t%d\n"
             "\n"
@@ -369,6 +370,7 @@ namespace Spartan
             // Renderer
             static_cast<int>(m_renderer->GetResolution().x), static_cast<int>(m_renderer->GetResolution().y),
             m_renderer_meshes_rendered,
+            m_renderer_draw_calls,
             texture_count,
             material_count,
 
@@ -95,6 +95,7 @@ namespace Spartan
 
         // Metrics - Renderer
         uint32_t m_renderer_meshes_rendered = 0;
+        uint32_t m_renderer_draw_calls      = 0; // geometry draws the passes issue (an instanced draw counts once), counted independently of the RHI
 
         // Metrics - Time
         float m_time_frame_avg  = 0.0f;
@@ -116,6 +117,7 @@ namespace Spartan
             m_rhi_draw                          = 0;
             m_rhi_dispatch                      = 0;
             m_renderer_meshes_rendered          = 0;
+            m_renderer_draw_calls               = 0;
             m_rhi_bindings_buffer_index         = 0;
             m_rhi_bindings_buffer_vertex        = 0;
             m_rhi_bindings_buffer_constant      = 0;
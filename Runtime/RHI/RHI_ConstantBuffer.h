@@ -37,7 +37,12 @@ namespace Spartan
         template<typename T>
         bool Create(const uint32_t offset_count = 1)
         {
-            m_stride        = static_cast<uint32_t>(sizeof(T));
+            return Create(static_cast<uint32_t>(sizeof(T)), offset_count);
+        }
+
+        bool Create(const uint32_t stride, const uint32_t offset_count)
+        {
+            m_stride        = stride;
             m_offset_count  = offset_count;
             m_size_gpu      = static_cast<uint64_t>(m_stride * m_offset_count);
 
@@ -67,7 +72,7 @@ namespace Spartan
         void _destroy();
 
         bool m_is_dynamic               = false;    // only affects Vulkan
-        bool m_persistent_mapping       = true;     // only affects Vulkan, saves 2 ms of CPU time
+        bool m_persistent_mapping       = true;     // only affects Vulkan, saves 2 ms of CPU time (the memory is coherent, so updates need no flush)
         void* m_mapped                  = nullptr;
         uint32_t m_stride               = 0;
         uint32_t m_offset_count         = 1;
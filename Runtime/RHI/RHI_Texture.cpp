@@ -27,12 +27,16 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Rendering/Renderer.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/Import/ImageImporter.h"
+#include "../Utilities/Hash.h"
 //===========================================
 
 //= NAMESPACES =====
 using namespace std;
 //==================
 
+// Bump when the import (or the layout of its derived data) changes, so that stale derived data is not used
+static const uint32_t derived_data_version = 1;
+
 namespace Spartan
 {
     RHI_Texture::RHI_Texture(Context* context) : IResource(context, ResourceType::Texture)
@@ -94,6 +98,10 @@ namespace Spartan
             // The bytes have been saved, so we can now free some memory
             m_data.clear();
             m_data.shrink_to_fit();
+
+            // The file has changed, so the offsets will have to be found again
+            lock_guard<mutex> lock(m_mip_offsets_mutex);
+            m_mip_offsets.clear();
         }
 
         // Write properties
@@ -171,6 +179,8 @@ namespace Spartan
                 m_size_cpu += mip_index < m_data.size() ? m_data[mip_index].size() * sizeof(std::byte) : 0;
                 m_size_gpu += mip_width * mip_height * (m_bits_per_channel / 8);
             }
+
+            m_context->GetSubsystem<ResourceCache>()->ResourceSizeChanged(this);
         }
 
         return true;
@@ -204,16 +214,32 @@ namespace Spartan
             auto file = make_unique<FileStream>(GetResourceFilePathNative(), FileStream_Read);
             if (file->IsOpen())
             {
-                auto byte_count = file->ReadAs<uint32_t>();
-                const uint32_t mip_count  = file->ReadAs<uint32_t>();
-
-                if (index < mip_count)
+                // The offsets are known if the texture was loaded from this file, otherwise the mips are skipped (not read) to find them
+                uint64_t offset = 0;
                 {
-                    for (uint8_t i = 0; i <= index; i++)
+                    lock_guard<mutex> lock(m_mip_offsets_mutex);
+                    if (m_mip_offsets.empty())
                     {
-                        file->Read(&data);
+                        file->Skip(sizeof(uint32_t)); // byte count
+                        const uint32_t mip_count = file->ReadAs<uint32_t>();
+                        for (uint32_t i = 0; i < mip_count; i++)
+                        {
+                            m_mip_offsets.emplace_back(file->GetPosition());
+                            file->Skip(file->ReadAs<uint32_t>());
+                        }
+                    }
+
+                    if (index < m_mip_offsets.size())
+                    {
+                        offset = m_mip_offsets[index];
                     }
                 }
+
+                if (offset != 0)
+                {
+                    file->Seek(offset);
+                    file->Read(&data);
+                }
                 else
                 {
                     LOG_ERROR("Invalid index");
@@ -231,10 +257,25 @@ namespace Spartan
 
     bool RHI_Texture::LoadFromFile_ForeignFormat(const string& file_path, const bool generate_mipmaps)
     {
-        // Load texture
-        ImageImporter* importer = m_context->GetSubsystem<ResourceCache>()->GetImageImporter();    
-        if (!importer->Load(file_path, this, generate_mipmaps))
-            return false;
+        ResourceCache* resource_cache = m_context->GetSubsystem<ResourceCache>();
+
+        // The import depends on the mips and on any dimensions which were requested (the importer rescales to them)
+        const uint32_t settings[]               = { derived_data_version, generate_mipmaps ? 1u : 0u, m_width, m_height };
+        const string derived_data_file_path     = resource_cache->GetDerivedDataFilePath(file_path, Utility::Hash::fnv1a_64(settings, sizeof(settings)), EXTENSION_TEXTURE);
+
+        // Decoding and mip generation are skipped if it has been imported before
+        if (derived_data_file_path.empty() || !LoadFromFile_DerivedData(derived_data_file_path))
+        {
+            // Load texture
+            ImageImporter* importer = resource_cache->GetImageImporter();
+            if (!importer->Load(file_path, this, generate_mipmaps))
+                return false;
+
+            if (!derived_data_file_path.empty())
+            {
+                SaveToFile_DerivedData(derived_data_file_path);
+            }
+        }
 
         // Set resource file path so it can be used by the resource cache
         SetResourceFilePath(file_path);
@@ -242,6 +283,84 @@ namespace Spartan
         return true;
     }
 
+    bool RHI_Texture::LoadFromFile_DerivedData(const string& file_path)
+    {
+        if (!FileSystem::IsFile(file_path))
+            return false;
+
+        auto file = make_unique<FileStream>(file_path, FileStream_Read);
+        if (!file->IsOpen())
+            return false;
+
+        // Read bytes
+        const auto mip_count = file->ReadAs<uint32_t>();
+        m_data.resize(mip_count);
+        for (auto& mip : m_data)
+        {
+            file->Read(&mip);
+        }
+
+        // Read properties
+        uint32_t bits_per_channel   = file->ReadAs<uint32_t>();
+        uint32_t width              = file->ReadAs<uint32_t>();
+        uint32_t height             = file->ReadAs<uint32_t>();
+        uint32_t format             = file->ReadAs<uint32_t>();
+        uint32_t channel_count      = file->ReadAs<uint32_t>();
+        uint16_t flags              = 0;
+        file->Read(&flags);
+
+        // A truncated file (e.g. another machine is still writing it to a shared directory) reads as zeros
+        if (mip_count == 0 || width == 0 || height == 0 || m_data.back().empty())
+        {
+            m_data.clear();
+            return false;
+        }
+
+        m_bits_per_channel  = bits_per_channel;
+        m_width             = width;
+        m_height            = height;
+        m_format            = static_cast<RHI_Format>(format);
+        m_channel_count     = channel_count;
+        SetGrayscale(flags & RHI_Texture_Grayscale);
+        SetTransparency(flags & RHI_Texture_Transparent);
+
+        return true;
+    }
+
+    bool RHI_Texture::SaveToFile_DerivedData(const string& file_path) const
+    {
+        // Written aside and then renamed, so that readers never see a partial file
+        const string file_path_temp = FileSystem::GetUniqueFilePath(file_path);
+        {
+            auto file = make_unique<FileStream>(file_path_temp, FileStream_Write);
+            if (!file->IsOpen())
+                return false;
+
+            // Write bytes
+            file->Write(static_cast<uint32_t>(m_data.size()));
+            for (const auto& mip : m_data)
+            {
+                file->Write(mip);
+            }
+
+            // Write properties (only those which come from the import)
+            file->Write(m_bits_per_channel);
+            file->Write(m_width);
+            file->Write(m_height);
+            file->Write(static_cast<uint32_t>(m_format));
+            file->Write(m_channel_count);
+            file->Write(static_cast<uint16_t>(m_flags & (RHI_Texture_Grayscale | RHI_Texture_Transparent)));
+        }
+
+        if (!FileSystem::Rename(file_path_temp, file_path))
+        {
+            FileSystem::Delete(file_path_temp);
+            return false;
+        }
+
+        return true;
+    }
+
     bool RHI_Texture::LoadFromFile_NativeFormat(const string& file_path)
     {
         auto file = make_unique<FileStream>(file_path, FileStream_Read);
@@ -257,9 +376,14 @@ namespace Spartan
 
         // Read bytes
         m_data.resize(mip_count);
-        for (auto& mip : m_data)
         {
-            file->Read(&mip);
+            lock_guard<mutex> lock(m_mip_offsets_mutex);
+            m_mip_offsets.clear();
+            for (auto& mip : m_data)
+            {
+                m_mip_offsets.emplace_back(file->GetPosition());
+                file->Read(&mip);
+            }
         }
 
         // Read properties
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <array>
+#include <mutex>
 #include "RHI_Viewport.h"
 #include "RHI_Definition.h"
 #include "../Resource/IResource.h"
@@ -127,6 +128,8 @@ namespace Spartan
     protected:
         bool LoadFromFile_NativeFormat(const std::string& file_path);
         bool LoadFromFile_ForeignFormat(const std::string& file_path, bool generate_mipmaps);
+        bool LoadFromFile_DerivedData(const std::string& file_path);
+        bool SaveToFile_DerivedData(const std::string& file_path) const;
         static uint32_t GetChannelCountFromFormat(RHI_Format format);
         virtual bool CreateResourceGpu() { LOG_ERROR("Function not implemented by API"); return false; }
 
@@ -141,6 +144,8 @@ namespace Spartan
         uint16_t m_flags            = 0;
         RHI_Viewport m_viewport;
         std::vector<std::vector<std::byte>> m_data;
+        std::vector<uint64_t> m_mip_offsets; // where each mip starts in the native file, so that a single one can be read
+        std::mutex m_mip_offsets_mutex;      // mips can be requested by several threads at once
         std::shared_ptr<RHI_Device> m_rhi_device;
 
         // API
@@ -475,7 +475,7 @@ namespace Spartan
         return true;
     }
 
-    bool RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset)
+    bool RHI_CommandList::DrawIndexed(const uint32_t index_count, const uint32_t index_offset, const uint32_t vertex_offset, const uint32_t instance_count)
     {
         if (m_cmd_state != RHI_CommandListState::Recording)
         {
@@ -490,7 +490,7 @@ namespace Spartan
         vkCmdDrawIndexed(
             static_cast<VkCommandBuffer>(m_cmd_buffer), // commandBuffer
             index_count,                                // indexCount
-            1,                                          // instanceCount
+            instance_count,                             // instanceCount
             index_offset,                               // firstIndex
             vertex_offset,                              // vertexOffset
             0                                           // firstInstance
@@ -35,6 +35,9 @@ namespace Spartan
 {
     void RHI_ConstantBuffer::_destroy()
     {
+        if (!m_buffer)
+            return;
+
         // Wait in case the buffer is still in use
         m_rhi_device->Queue_WaitAll();
 
@@ -76,8 +79,7 @@ namespace Spartan
         m_size_gpu = m_offset_count * m_stride;
 
         // Create buffer
-        VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
-        flags |= !m_persistent_mapping ? VK_MEMORY_PROPERTY_HOST_COHERENT_BIT : 0;
+        VkMemoryPropertyFlags flags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
         VmaAllocation allocation = vulkan_utility::buffer::create(m_buffer, m_size_gpu, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, flags, true);
         if (!allocation)
         {
@@ -133,21 +135,11 @@ namespace Spartan
             return false;
         }
 
-        if (m_persistent_mapping)
-        {
-            if (!vulkan_utility::error::check(vmaFlushAllocation(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_allocation), offset, size != 0 ? size : VK_WHOLE_SIZE)))
-            {
-                LOG_ERROR("Failed to flush memory");
-                return false;
-            }
-        }
-        else
+        // Persistently mapped memory is coherent, so writes are visible to the GPU without a flush
+        if (!m_persistent_mapping && m_mapped)
         {
-            if (m_mapped)
-            {
-                vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_allocation));
-                m_mapped = nullptr;
-            }
+            vmaUnmapMemory(m_rhi_device->GetContextRhi()->allocator, static_cast<VmaAllocation>(m_allocation));
+            m_mapped = nullptr;
         }
 
         return true;
@@ -19,7 +19,7 @@ IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
 CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 */
 
-//= INCLUDES =========================
+//= INCLUDES ===============================
 #include "Spartan.h"
 #include "Material.h"
 #include "Renderer.h"
@@ -29,7 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
 #include "../World/World.h"
-//====================================
+#include "../World/Components/Renderable.h"
+//==========================================
 
 //= NAMESPACES ===============
 using namespace std;
@@ -103,6 +104,7 @@ namespace Spartan
         ShaderGBuffer::GenerateVariation(m_context, m_flags);
 
         m_size_cpu = sizeof(*this);
+        m_context->GetSubsystem<ResourceCache>()->ResourceSizeChanged(this);
 
         return true;
     }
@@ -219,11 +221,18 @@ namespace Spartan
 
     void Material::SetColorAlbedo(const Math::Vector4& color)
     {
-        // If an object switches from opaque to transparent or vice versa, make the world update so that the renderer
-        // goes through the entities and makes the ones that use this material, render in the correct mode.
+        // If an object switches from opaque to transparent or vice versa, the renderer has to re-classify
+        // the entities which use this material, so that they render in the correct mode.
         if ((m_color_albedo.w != 1.0f && color.w == 1.0f) || (m_color_albedo.w == 1.0f && color.w != 1.0f))
         {
-            m_context->GetSubsystem<World>()->MakeDirty();
+            Renderer* renderer = m_context->GetSubsystem<Renderer>();
+            m_context->GetSubsystem<World>()->ForEachComponent<Renderable>([this, renderer](Renderable* renderable)
+            {
+                if (renderable->GetMaterial() == this)
+                {
+                    renderer->RenderablesChanged(renderable);
+                }
+            });
         }
 
         m_color_albedo = color;
@@ -63,6 +63,7 @@ namespace Spartan
         m_index_buffer.reset();
         m_mesh->Clear();
         m_aabb.Undefine();
+        TriangleBvhClear();
         m_normalized_scale = 1.0f;
         m_is_animated = false;
     }
@@ -121,6 +122,8 @@ namespace Spartan
                 m_size_gpu = m_vertex_buffer->GetSizeGpu();
                 m_size_gpu += m_index_buffer->GetSizeGpu();
             }
+
+            m_resource_manager->ResourceSizeChanged(this);
         }
 
         LOG_INFO("Loading \"%s\" took %d ms", FileSystem::GetFileNameFromFilePath(file_path).c_str(), static_cast<int>(timer.GetElapsedTimeMs()));
@@ -162,6 +165,39 @@ namespace Spartan
         m_mesh->GetGeometry(index_offset, index_count, vertex_offset, vertex_count, indices, vertices);
     }
 
+    const TriangleBvh* Model::GetTriangleBvh(const uint32_t index_offset, const uint32_t index_count, const uint32_t vertex_offset, const uint32_t vertex_count) const
+    {
+        if (index_count == 0 || vertex_count == 0 || index_offset + index_count > m_mesh->Indices_Count() || vertex_offset + vertex_count > m_mesh->Vertices_Count())
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return nullptr;
+        }
+
+        // Parts of the geometry never share an index offset, so that's enough to identify them
+        lock_guard<mutex> lock(m_triangle_bvh_mutex);
+        unique_ptr<TriangleBvh>& bvh = m_triangle_bvhs[(static_cast<uint64_t>(index_offset) << 32) | index_count];
+        if (!bvh)
+        {
+            // Built straight from the mesh, the indices are relative to the vertex offset
+            bvh = make_unique<TriangleBvh>();
+            bvh->Build(
+                m_mesh->Vertices_Get()[vertex_offset].pos,
+                sizeof(RHI_Vertex_PosTexNorTan),
+                vertex_count,
+                m_mesh->Indices_Get().data() + index_offset,
+                index_count
+            );
+        }
+
+        return bvh.get();
+    }
+
+    void Model::TriangleBvhClear()
+    {
+        lock_guard<mutex> lock(m_triangle_bvh_mutex);
+        m_triangle_bvhs.clear();
+    }
+
     void Model::UpdateGeometry()
     {
         if (m_mesh->Indices_Count() == 0 || m_mesh->Vertices_Count() == 0)
@@ -171,6 +207,7 @@ namespace Spartan
         }
 
         GeometryCreateBuffers();
+        TriangleBvhClear();
         m_normalized_scale    = GeometryComputeNormalizedScale();
         m_aabb                = BoundingBox(m_mesh->Vertices_Get().data(), static_cast<uint32_t>(m_mesh->Vertices_Get().size()));
     }
@@ -24,10 +24,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 //= INCLUDES =====================
 #include <memory>
 #include <vector>
+#include <mutex>
+#include <unordered_map>
 #include "Material.h"
 #include "../RHI/RHI_Definition.h"
 #include "../Resource/IResource.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/TriangleBvh.h"
 //================================
 
 namespace Spartan
@@ -66,6 +69,8 @@ namespace Spartan
             std::vector<RHI_Vertex_PosTexNorTan>* vertices
         ) const;
         void UpdateGeometry();
+        // Returns the triangle BVH of a part of the geometry, it's built the first time it's requested
+        const Math::TriangleBvh* GetTriangleBvh(uint32_t index_offset, uint32_t index_count, uint32_t vertex_offset, uint32_t vertex_count) const;
         const auto& GetAabb() const { return m_aabb; }
         const auto& GetMesh() const { return m_mesh; }
 
@@ -85,6 +90,7 @@ namespace Spartan
         // Geometry
         bool GeometryCreateBuffers();
         float GeometryComputeNormalizedScale() const;
+        void TriangleBvhClear();
 
         // Misc
         std::weak_ptr<Entity> m_root_entity;
@@ -92,6 +98,8 @@ namespace Spartan
         std::shared_ptr<RHI_IndexBuffer> m_index_buffer;
         std::shared_ptr<Mesh> m_mesh;
         Math::BoundingBox m_aabb;
+        mutable std::unordered_map<uint64_t, std::unique_ptr<Math::TriangleBvh>> m_triangle_bvhs;
+        mutable std::mutex m_triangle_bvh_mutex;
         float m_normalized_scale    = 1.0f;
         bool m_is_animated            = false;
 
@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Utilities/Sampling.h"
 #include "../Profiling/Profiler.h"
 #include "../Resource/ResourceCache.h"
+#include "../Threading/Threading.h"
 #include "../World/Entity.h"
 #include "../World/Components/Transform.h"
 #include "../World/Components/Renderable.h"
@@ -84,14 +85,13 @@ namespace Spartan
         m_option_values[Option_Value_Fog]               = 0.1f;
 
         // Subscribe to events
-        SUBSCRIBE_TO_EVENT(EventType::WorldResolved,    EVENT_HANDLER_VARIANT(RenderablesAcquire));
-        SUBSCRIBE_TO_EVENT(EventType::WorldUnload,      EVENT_HANDLER(ClearEntities));
+        SUBSCRIBE_TO_EVENT(EventType::WorldUnload, EVENT_HANDLER(ClearEntities));
     }
 
     Renderer::~Renderer()
     {
         // Unsubscribe from events
-        UNSUBSCRIBE_FROM_EVENT(EventType::WorldResolved, EVENT_HANDLER_VARIANT(RenderablesAcquire));
+        UNSUBSCRIBE_FROM_EVENT(EventType::WorldUnload, EVENT_HANDLER(ClearEntities));
 
         m_entities.clear();
         m_camera = nullptr;
@@ -105,6 +105,7 @@ namespace Spartan
         // Get required systems        
         m_resource_cache    = m_context->GetSubsystem<ResourceCache>();
         m_profiler          = m_context->GetSubsystem<Profiler>();
+        m_threading         = m_context->GetSubsystem<Threading>();
 
         // Resolution, viewport and swapchain default to whatever the window size is
         const WindowData& window_data = m_context->m_engine->GetWindowData();
@@ -198,6 +199,9 @@ namespace Spartan
 
         RHI_CommandList* cmd_list = m_swap_chain->GetCmdList();
 
+        // Apply any additions/removals to the render lists
+        RenderablesUpdate();
+
         // If there is no camera, clear to black
         if (!m_camera)
         {
@@ -212,15 +216,8 @@ namespace Spartan
             return;
         }
 
-        // Reset dynamic buffer indices when the swapchain resets to first buffer/command list
-        if (m_swap_chain->GetCmdIndex() == 0)
-        {
-            m_buffer_uber_offset_index      = 0;
-            m_buffer_object_offset_index    = 0;
-            m_buffer_frame_offset_index     = 0;
-            m_buffer_light_offset_index     = 0;
-            m_buffer_material_offset_index  = 0;
-        }
+        // Start sub-allocating dynamic buffer updates from the beginning of this frame's partition
+        DynamicBufferReclaim(cmd_list);
 
         // Update frame buffer
         {
@@ -280,6 +277,12 @@ namespace Spartan
             m_buffer_frame_cpu.frame                        = static_cast<uint32_t>(m_frame_num);
         }
 
+        // Determine what the camera and the lights can see, the passes only iterate over that
+        RenderablesCull();
+
+        // Sort what the camera can see by state and depth
+        DrawPacketsBuild();
+
         m_is_rendering = true;
         Pass_Main(cmd_list);
         m_is_rendering = false;
@@ -347,61 +350,86 @@ namespace Spartan
         LOG_INFO("Resolution set to %dx%d", width, height);
     }
 
-    template<typename T>
-    bool update_dynamic_buffer(RHI_CommandList* cmd_list, RHI_ConstantBuffer* buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
+    void* Renderer::DynamicBufferAllocate(shared_ptr<RHI_ConstantBuffer>& buffer, uint32_t& offset_index, uint64_t& offset)
     {
-        // Only update if needed
-        if (buffer_cpu == buffer_cpu_previous)
-            return true;
-
-        offset_index++;
+        // D3D11 buffers are not dynamic, mapping them discards the previous contents (the driver renames them for us)
+        if (!buffer->IsDynamic())
+        {
+            offset_index++;
+            offset = 0;
+            return buffer->Map();
+        }
 
-        // Re-allocate buffer with double size (if needed)
-        if (buffer_gpu->IsDynamic())
+        // Out of slots for this frame, so allocate a bigger buffer instead of flushing and re-allocating in place.
+        // The previous buffer is still referenced by the frames in flight, so it's retired instead of destroyed.
+        const uint32_t slots_per_frame = buffer->GetOffsetCount() / m_swap_chain_buffer_count;
+        if (offset_index >= slots_per_frame)
         {
-            if (offset_index >= buffer_gpu->GetOffsetCount())
+            const uint32_t slots_per_frame_new  = Math::Helper::NextPowerOfTwo(offset_index + 1);
+            shared_ptr<RHI_ConstantBuffer> buffer_new = make_shared<RHI_ConstantBuffer>(m_rhi_device, buffer->GetName(), true);
+            if (!buffer_new->Create(buffer->GetStride(), slots_per_frame_new * m_swap_chain_buffer_count))
             {
-                cmd_list->Flush();
-                const uint32_t new_size = Math::Helper::NextPowerOfTwo(offset_index + 1);
-                if (!buffer_gpu->Create<T>(new_size))
-                {
-                    LOG_ERROR("Failed to re-allocate %s buffer with %d offsets", buffer_gpu->GetName().c_str(), new_size);
-                    return false;
-                }
-                LOG_INFO("Increased %s buffer offsets to %d, that's %d kb", buffer_gpu->GetName().c_str(), new_size, (new_size * buffer_gpu->GetStride()) / 1000);
+                LOG_ERROR("Failed to re-allocate %s buffer with %d offsets", buffer->GetName().c_str(), slots_per_frame_new * m_swap_chain_buffer_count);
+                return nullptr;
             }
+            LOG_INFO("Increased %s buffer offsets to %d per frame, that's %d kb", buffer->GetName().c_str(), slots_per_frame_new, static_cast<uint32_t>(buffer_new->GetSizeGpu() / 1000));
+
+            m_buffers_retired.emplace_back(buffer, m_swap_chain->GetCmdIndex());
+            buffer = buffer_new;
         }
 
-        // Set new buffer offset
-        if (buffer_gpu->IsDynamic())
+        // Persistently mapped, so this is just a pointer
+        std::byte* data = static_cast<std::byte*>(buffer->Map());
+        if (!data)
+            return nullptr;
+
+        const uint32_t slot = m_swap_chain->GetCmdIndex() * (buffer->GetOffsetCount() / m_swap_chain_buffer_count) + offset_index++;
+        buffer->SetOffsetIndexDynamic(slot);
+        offset = static_cast<uint64_t>(slot) * buffer->GetStride();
+
+        return data + offset;
+    }
+
+    void Renderer::DynamicBufferReclaim(RHI_CommandList* cmd_list)
+    {
+        // The partitions of this frame were last used by this command list, so once it's done, they can be written to again
+        if (!cmd_list->Wait())
         {
-            buffer_gpu->SetOffsetIndexDynamic(offset_index);
+            LOG_ERROR("Failed to wait for command list");
+            return;
         }
 
-        // Map  
-        T* buffer = static_cast<T*>(buffer_gpu->Map());
-        if (!buffer)
+        m_buffer_uber_offset_index      = 0;
+        m_buffer_object_offset_index    = 0;
+        m_buffer_frame_offset_index     = 0;
+        m_buffer_light_offset_index     = 0;
+        m_buffer_material_offset_index  = 0;
+        m_buffer_instance_offset_index  = 0;
+
+        // Submissions complete in order, so a buffer retired during this frame is no longer referenced by any frame
+        const uint32_t cmd_index = m_swap_chain->GetCmdIndex();
+        m_buffers_retired.erase(remove_if(m_buffers_retired.begin(), m_buffers_retired.end(), [cmd_index](const auto& retired) { return retired.second == cmd_index; }), m_buffers_retired.end());
+    }
+
+    template<typename T>
+    bool Renderer::DynamicBufferUpdate(shared_ptr<RHI_ConstantBuffer>& buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index)
+    {
+        // Only update if needed, but always once per frame as the previous update lives in another frame's partition
+        if (offset_index != 0 && buffer_cpu == buffer_cpu_previous)
+            return true;
+
+        uint64_t offset = 0;
+        void* data = DynamicBufferAllocate(buffer_gpu, offset_index, offset);
+        if (!data)
         {
             LOG_ERROR("Failed to map buffer");
             return false;
         }
 
-        const uint64_t size   = buffer_gpu->GetStride();
-        const uint64_t offset = offset_index * size;
-
-        // Update
-        if (buffer_gpu->IsDynamic())
-        {
-            memcpy(reinterpret_cast<std::byte*>(buffer) + offset, reinterpret_cast<std::byte*>(&buffer_cpu), size);
-        }
-        else
-        {
-            *buffer = buffer_cpu;
-        }
+        memcpy(data, reinterpret_cast<std::byte*>(&buffer_cpu), sizeof(T));
         buffer_cpu_previous = buffer_cpu;
 
-        // Unmap
-        return buffer_gpu->Unmap(offset, size);
+        return buffer_gpu->Unmap(offset, buffer_gpu->GetStride());
     }
 
     bool Renderer::UpdateFrameBuffer(RHI_CommandList* cmd_list)
@@ -424,7 +452,7 @@ namespace Spartan
             return false;
         }
 
-        if (!update_dynamic_buffer<BufferFrame>(cmd_list, m_buffer_frame_gpu.get(), m_buffer_frame_cpu, m_buffer_frame_cpu_previous, m_buffer_frame_offset_index))
+        if (!DynamicBufferUpdate<BufferFrame>(m_buffer_frame_gpu, m_buffer_frame_cpu, m_buffer_frame_cpu_previous, m_buffer_frame_offset_index))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
@@ -454,7 +482,7 @@ namespace Spartan
             m_buffer_material_cpu.mat_sheen_sheenTint_pad[i].y = material->GetProperty(Material_Sheen_Tint);
         }
 
-        if (!update_dynamic_buffer<BufferMaterial>(cmd_list, m_buffer_material_gpu.get(), m_buffer_material_cpu, m_buffer_material_cpu_previous, m_buffer_material_offset_index))
+        if (!DynamicBufferUpdate<BufferMaterial>(m_buffer_material_gpu, m_buffer_material_cpu, m_buffer_material_cpu_previous, m_buffer_material_offset_index))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
@@ -469,7 +497,7 @@ namespace Spartan
             return false;
         }
 
-        if (!update_dynamic_buffer<BufferUber>(cmd_list, m_buffer_uber_gpu.get(), m_buffer_uber_cpu, m_buffer_uber_cpu_previous, m_buffer_uber_offset_index))
+        if (!DynamicBufferUpdate<BufferUber>(m_buffer_uber_gpu, m_buffer_uber_cpu, m_buffer_uber_cpu_previous, m_buffer_uber_offset_index))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
@@ -484,7 +512,7 @@ namespace Spartan
             return false;
         }
 
-        if (!update_dynamic_buffer<BufferObject>(cmd_list, m_buffer_object_gpu.get(), m_buffer_object_cpu, m_buffer_object_cpu_previous, m_buffer_object_offset_index))
+        if (!DynamicBufferUpdate<BufferObject>(m_buffer_object_gpu, m_buffer_object_cpu, m_buffer_object_cpu_previous, m_buffer_object_offset_index))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
@@ -529,79 +557,197 @@ namespace Spartan
         m_buffer_light_cpu.position                     = light->GetTransform()->GetPosition();
         m_buffer_light_cpu.direction                    = light->GetDirection();
 
-        if (!update_dynamic_buffer<BufferLight>(cmd_list, m_buffer_light_gpu.get(), m_buffer_light_cpu, m_buffer_light_cpu_previous, m_buffer_light_offset_index))
+        if (!DynamicBufferUpdate<BufferLight>(m_buffer_light_gpu, m_buffer_light_cpu, m_buffer_light_cpu_previous, m_buffer_light_offset_index))
             return false;
 
         // Dynamic buffers with offsets have to be rebound whenever the offset changes
         return cmd_list->SetConstantBuffer(4, RHI_Shader_Pixel, m_buffer_light_gpu);
     }
 
-    void Renderer::RenderablesAcquire(const Variant& entities_variant)
+    bool Renderer::UpdateInstanceBuffer(RHI_CommandList* cmd_list, const uint32_t instance_count)
     {
-        SCOPED_TIME_BLOCK(m_profiler);
+        if (!cmd_list || instance_count == 0 || instance_count > max_instances)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
 
-        // Clear previous state
-        m_entities.clear();
-        m_camera = nullptr;
+        // Instances always change, so unlike the other buffers there is no comparison with the previous update
+        uint64_t offset = 0;
+        void* data = DynamicBufferAllocate(m_buffer_instance_gpu, m_buffer_instance_offset_index, offset);
+        if (!data)
+        {
+            LOG_ERROR("Failed to map buffer");
+            return false;
+        }
+
+        // Only copy the instances which will be drawn
+        const uint64_t size = instance_count * sizeof(BufferInstance::Instance);
+        memcpy(data, m_buffer_instance_cpu.instances.data(), size);
+
+        if (!m_buffer_instance_gpu->Unmap(offset, size))
+            return false;
 
-        vector<shared_ptr<Entity>> entities = entities_variant.Get<vector<shared_ptr<Entity>>>();
-        for (const auto& entity : entities)
+        // Dynamic buffers with offsets have to be rebound whenever the offset changes
+        return cmd_list->SetConstantBuffer(5, RHI_Shader_Vertex, m_buffer_instance_gpu);
+    }
+
+    void Renderer::RenderablesQueue(IComponent* component, const Renderables_Change change)
+    {
+        if (!component)
         {
-            if (!entity || !entity->IsActive())
-                continue;
+            LOG_ERROR_INVALID_PARAMETER();
+            return;
+        }
+
+        const ComponentType type = component->GetType();
+        if (type != ComponentType::Renderable && type != ComponentType::Light && type != ComponentType::Camera)
+            return;
+
+        // Only entities which are in the world are tracked, anything else could be gone before the queue is applied
+        Entity* entity = component->GetEntity();
+        if (change != Renderables_Change_Remove && !entity->GetHandle().IsValid())
+            return;
+
+        lock_guard<mutex> lock(m_renderables_changes_mutex);
+
+        // A removal cancels whatever is still queued for the component, as the entity might not outlive the queue
+        if (change == Renderables_Change_Remove)
+        {
+            m_renderables_changes.erase(remove_if(m_renderables_changes.begin(), m_renderables_changes.end(), [component](const RenderablesChange& queued)
+            {
+                return queued.component == component;
+            }), m_renderables_changes.end());
+        }
+
+        m_renderables_changes.push_back({ component, entity, entity->GetHandle().index, type, change });
+    }
+
+    void Renderer::RenderablesUpdate()
+    {
+        // Changes can come from any thread (e.g. a model loading), but the lists are only touched here, before rendering
+        vector<RenderablesChange> changes;
+        {
+            lock_guard<mutex> lock(m_renderables_changes_mutex);
+            if (m_renderables_changes.empty())
+                return;
+
+            changes.swap(m_renderables_changes);
+        }
 
-            // Get all the components we are interested in
-            Renderable* renderable  = entity->GetComponent<Renderable>();
-            Light* light            = entity->GetComponent<Light>();
-            Camera* camera          = entity->GetComponent<Camera>();
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        bool camera_removed = false;
+        for (const RenderablesChange& change : changes)
+        {
+            const ComponentType type = change.type;
 
-            if (renderable)
+            if (type == ComponentType::Renderable)
             {
-                bool is_transparent = false;
+                // An update re-classifies the entity, as its material (and therefore transparency) might have changed
+                if (change.change != Renderables_Change_Add)
+                {
+                    RenderableErase(change.handle_index);
+                }
 
-                if (const Material* material = renderable->GetMaterial())
+                if (change.change != Renderables_Change_Remove && change.entity->IsActive())
                 {
-                    is_transparent = material->GetColorAlbedo().w < 1.0f;
+                    RenderableInsert(change.entity);
                 }
 
-                m_entities[is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque].emplace_back(entity.get());
+                continue;
             }
 
-            if (light)
+            // Lights and cameras are few, so a linear search is fine
+            vector<Entity*>& entities = m_entities[type == ComponentType::Light ? Renderer_Object_Light : Renderer_Object_Camera];
+            auto it = find(entities.begin(), entities.end(), change.entity);
+
+            if (change.change == Renderables_Change_Remove)
             {
-                m_entities[Renderer_Object_Light].emplace_back(entity.get());
-            }
+                if (it != entities.end())
+                {
+                    entities.erase(it);
+                }
 
-            if (camera)
+                if (type == ComponentType::Camera && m_camera.get() == change.component)
+                {
+                    m_camera        = nullptr;
+                    camera_removed  = true;
+                }
+            }
+            else if (it == entities.end() && change.entity->IsActive())
             {
-                m_entities[Renderer_Object_Camera].emplace_back(entity.get());
-                m_camera = camera->GetPtrShared<Camera>();
+                entities.emplace_back(change.entity);
+
+                if (type == ComponentType::Camera)
+                {
+                    m_camera        = static_cast<Camera*>(change.component)->GetPtrShared<Camera>();
+                    camera_removed  = false;
+                }
             }
         }
 
-        RenderablesSort(&m_entities[Renderer_Object_Opaque]);
-        RenderablesSort(&m_entities[Renderer_Object_Transparent]);
+        // Fall back to any other camera, once all the removals are in (a camera later in the list could be gone too)
+        if (camera_removed)
+        {
+            const vector<Entity*>& cameras = m_entities[Renderer_Object_Camera];
+            if (!cameras.empty())
+            {
+                m_camera = cameras.back()->GetComponent<Camera>()->GetPtrShared<Camera>();
+            }
+        }
     }
 
-    void Renderer::RenderablesSort(vector<Entity*>* renderables)
+    void Renderer::RenderableInsert(Entity* entity)
     {
-        if (!m_camera || renderables->size() <= 2)
+        // Handles are dense, so they index an array instead of hashing pointers
+        const uint32_t handle_index = entity->GetHandle().index;
+        if (handle_index == EntityHandle::index_invalid)
             return;
 
-        auto comparison_op = [this](Entity* entity)
+        if (handle_index >= static_cast<uint32_t>(m_cull_keys.size()))
         {
-            auto renderable = entity->GetRenderable();
-            if (!renderable)
-                return 0.0f;
+            m_cull_keys.resize(handle_index + 1, cull_key_none);
+        }
 
-            return (renderable->GetAabb().GetCenter() - m_camera->GetTransform()->GetPosition()).LengthSquared();
-        };
+        if (m_cull_keys[handle_index] != cull_key_none)
+            return;
 
-        // Sort by depth (front to back)
-        sort(renderables->begin(), renderables->end(), [&comparison_op](Entity* a, Entity* b)
+        bool is_transparent = false;
+        if (const Material* material = entity->GetRenderable()->GetMaterial())
         {
-            return comparison_op(a) < comparison_op(b);
-        });
+            is_transparent = material->GetColorAlbedo().w < 1.0f;
+        }
+
+        const Renderer_Object_Type object_type  = is_transparent ? Renderer_Object_Transparent : Renderer_Object_Opaque;
+        vector<Entity*>& entities               = m_entities[object_type];
+        m_cull_keys[handle_index]               = static_cast<uint32_t>(entities.size()) | (is_transparent ? cull_key_transparent : 0);
+        entities.emplace_back(entity);
+        m_entities_handle[object_type].emplace_back(handle_index);
+    }
+
+    void Renderer::RenderableErase(const uint32_t handle_index)
+    {
+        if (handle_index >= static_cast<uint32_t>(m_cull_keys.size()) || m_cull_keys[handle_index] == cull_key_none)
+            return;
+
+        const uint32_t key                      = m_cull_keys[handle_index];
+        const uint32_t index                    = key & ~cull_key_transparent;
+        const Renderer_Object_Type object_type  = (key & cull_key_transparent) ? Renderer_Object_Transparent : Renderer_Object_Opaque;
+        vector<Entity*>& entities               = m_entities[object_type];
+        vector<uint32_t>& handles               = m_entities_handle[object_type];
+
+        // Swap with the last one and pop, the moved entity's key is fixed up without touching the entity itself
+        const uint32_t index_last = static_cast<uint32_t>(entities.size()) - 1;
+        if (index != index_last)
+        {
+            entities[index]             = entities[index_last];
+            handles[index]              = handles[index_last];
+            m_cull_keys[handles[index]] = index | (key & cull_key_transparent);
+        }
+        entities.pop_back();
+        handles.pop_back();
+        m_cull_keys[handle_index] = cull_key_none;
     }
 
     void Renderer::ClearEntities()
@@ -616,6 +762,16 @@ namespace Spartan
         }
 
         m_entities.clear();
+        m_entities_handle.clear();
+        m_entities_visible.clear();
+        m_entities_visible_light.clear();
+        m_draw_packets.clear();
+        m_draw_packets_light.clear();
+        m_cull_keys.clear();
+        m_camera = nullptr;
+
+        lock_guard<mutex> lock(m_renderables_changes_mutex);
+        m_renderables_changes.clear();
     }
 
     const shared_ptr<Spartan::RHI_Texture>& Renderer::GetEnvironmentTexture()
@@ -25,11 +25,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <unordered_map>
 #include <array>
 #include <atomic>
+#include <mutex>
 #include "Renderer_ConstantBuffers.h"
 #include "Renderer_Enums.h"
 #include "Material.h"
 #include "../Core/ISubsystem.h"
 #include "../Math/Rectangle.h"
+#include "../Math/Frustum.h"
 #include "../RHI/RHI_Definition.h"
 #include "../RHI/RHI_Viewport.h"
 #include "../RHI/RHI_Vertex.h"
@@ -47,6 +49,11 @@ namespace Spartan
     class Grid;
     class Transform_Gizmo;
     class Profiler;
+    class Threading;
+    class IComponent;
+    class Renderable;
+    class Model;
+    enum class ComponentType : uint32_t;
 
     namespace Math
     {
@@ -151,6 +158,11 @@ namespace Spartan
         // Passes
         void Pass_CopyToBackbuffer(RHI_CommandList* cmd_list);
 
+        // Render lists, kept up to date by the World as components come and go (safe to call from any thread, applied on the next tick)
+        void RenderablesAdd(IComponent* component)      { RenderablesQueue(component, Renderables_Change_Add); }
+        void RenderablesRemove(IComponent* component)   { RenderablesQueue(component, Renderables_Change_Remove); }
+        void RenderablesChanged(IComponent* component)  { RenderablesQueue(component, Renderables_Change_Update); }
+
     private:
         // Resource creation
         void CreateConstantBuffers();
@@ -204,12 +216,60 @@ namespace Spartan
         bool UpdateUberBuffer(RHI_CommandList* cmd_list);
         bool UpdateObjectBuffer(RHI_CommandList* cmd_list);
         bool UpdateLightBuffer(RHI_CommandList* cmd_list, const Light* light);
-
-        // Misc
-        void RenderablesAcquire(const Variant& renderables);
-        void RenderablesSort(std::vector<Entity*>* renderables);
+        bool UpdateInstanceBuffer(RHI_CommandList* cmd_list, uint32_t instance_count);
+        // Dynamic buffers hold one partition of slots per frame in flight, updates sub-allocate from the current frame's partition
+        void* DynamicBufferAllocate(std::shared_ptr<RHI_ConstantBuffer>& buffer, uint32_t& offset_index, uint64_t& offset);
+        void DynamicBufferReclaim(RHI_CommandList* cmd_list);
+        template<typename T>
+        bool DynamicBufferUpdate(std::shared_ptr<RHI_ConstantBuffer>& buffer_gpu, T& buffer_cpu, T& buffer_cpu_previous, uint32_t& offset_index);
+
+        // Render lists
+        enum Renderables_Change : uint8_t
+        {
+            Renderables_Change_Add,
+            Renderables_Change_Remove,
+            Renderables_Change_Update
+        };
+        // Everything is captured when queued, as by the time a removal is applied the component and the entity can be gone
+        // (so for removals, they are only compared against, never dereferenced)
+        struct RenderablesChange
+        {
+            IComponent* component;
+            Entity* entity;
+            uint32_t handle_index;
+            ComponentType type;
+            Renderables_Change change;
+        };
+        void RenderablesQueue(IComponent* component, Renderables_Change change);
+        void RenderablesUpdate();
+        void RenderableInsert(Entity* entity);
+        void RenderableErase(uint32_t handle_index);
         void ClearEntities();
 
+        // Culling
+        void RenderablesCull();
+
+        // Draw packets, the visible renderables sorted by a key which packs (from most to least significant 16 bits)
+        // shader variation (and whether it's instanced), material, mesh and depth. Passes walk them in order, so state
+        // only changes when it has to, and consecutive packets of the same mesh and material become one instanced draw.
+        struct DrawPacket
+        {
+            Entity* entity;
+            Renderable* renderable;
+            Material* material;
+            const Model* model;
+            bool instanced;
+        };
+        struct DrawKey
+        {
+            uint64_t key;
+            uint32_t index;
+        };
+        void DrawPacketsBuild();
+        void DrawPacketsBuild(const std::vector<Entity*>& entities, std::vector<DrawPacket>& packets, const Math::Vector3& eye_position, bool is_transparent);
+        void DrawKeysSort();
+        static uint32_t DrawPacketsInstanceCount(const std::vector<DrawPacket>& packets, uint32_t index);
+
         // Render textures
         std::unordered_map<RendererRt, std::shared_ptr<RHI_Texture>> m_render_targets;
         std::vector<std::shared_ptr<RHI_Texture>> m_render_tex_bloom;
@@ -322,15 +382,53 @@ namespace Spartan
         BufferLight m_buffer_light_cpu_previous;
         std::shared_ptr<RHI_ConstantBuffer> m_buffer_light_gpu;
         uint32_t m_buffer_light_offset_index = 0;
+
+        BufferInstance m_buffer_instance_cpu;
+        std::shared_ptr<RHI_ConstantBuffer> m_buffer_instance_gpu;
+        uint32_t m_buffer_instance_offset_index = 0;
+
+        // Buffers which were outgrown, kept alive until the frame (command list index) that replaced them comes around again
+        std::vector<std::pair<std::shared_ptr<RHI_ConstantBuffer>, uint32_t>> m_buffers_retired;
         //========================================================
 
         // Entities and material references
         std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities;
         std::array<Material*, m_max_material_instances> m_material_instances;    
+
+        // Visible entities, built once per frame by RenderablesCull() and consumed by the passes
+        std::unordered_map<Renderer_Object_Type, std::vector<Entity*>> m_entities_visible;                                 // camera
+        std::unordered_map<Renderer_Object_Type, std::vector<std::vector<std::vector<Entity*>>>> m_entities_visible_light;  // [light index][shadow slice]
+        static constexpr uint32_t cull_key_transparent = 0x80000000;
+        static constexpr uint32_t cull_key_none        = 0xFFFFFFFF;
+        std::vector<uint32_t> m_cull_keys;  // indexed by entity handle, the object type (top bit) and the index in m_entities
+        std::unordered_map<Renderer_Object_Type, std::vector<uint32_t>> m_entities_handle; // parallel to m_entities (opaque and transparent), so that removals never touch an entity
+        std::vector<RenderablesChange> m_renderables_changes;
+        std::mutex m_renderables_changes_mutex;
+        std::vector<Light*> m_cull_lights;
+        std::vector<uint32_t> m_cull_visibility;                    // a bit per entity, for the camera and then for every shadow slice
+        struct CullCandidates
+        {
+            std::vector<uint32_t> keys;
+            Math::BoundingBoxSoA boxes;
+            std::vector<uint32_t> visibility;                       // a bit per candidate, from the exact test
+        };
+        std::vector<CullCandidates> m_cull_candidates;              // per view, the entities whose boxes straddle its frustum
+        static constexpr uint32_t cull_batch_size = 1024;           // candidates per exact test task, a multiple of 32
+
+        // Draw packets
+        static constexpr uint32_t draw_keys_parallel_threshold = 16384;
+        std::unordered_map<Renderer_Object_Type, std::vector<DrawPacket>> m_draw_packets;                                  // camera
+        std::unordered_map<Renderer_Object_Type, std::vector<std::vector<std::vector<DrawPacket>>>> m_draw_packets_light;   // [light index][shadow slice]
+        std::vector<DrawPacket> m_draw_packets_unsorted;
+        std::vector<DrawKey> m_draw_keys;
+        std::vector<DrawKey> m_draw_keys_scratch;
+        std::unordered_map<uint64_t, uint32_t> m_draw_ids;          // object id to a small per list id, so that it fits in 16 bits
+        std::unordered_map<uint32_t, uint32_t> m_draw_instance_counts;
         std::shared_ptr<Camera> m_camera;
 
         // Dependencies
         Profiler* m_profiler            = nullptr;
         ResourceCache* m_resource_cache = nullptr;
+        Threading* m_threading          = nullptr;
     };
 }
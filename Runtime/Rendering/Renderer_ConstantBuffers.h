@@ -186,6 +186,20 @@ namespace Spartan
         bool operator!=(const BufferObject& rhs) const { return !(*this == rhs); }
     };
     
+    // High frequency - Updates per instanced draw, only the instances which are drawn are written
+    static const uint32_t max_instances = 64; // must match g_max_instances in Common_Buffer.hlsl
+    struct BufferInstance
+    {
+        struct Instance
+        {
+            Math::Matrix transform;
+            Math::Matrix wvp_previous;
+        };
+
+        std::array<Instance, max_instances> instances;
+    };
+    static_assert(sizeof(BufferInstance) == max_instances * 2 * 16 * sizeof(float), "BufferInstance must match the layout of the BufferInstance cbuffer in Common_Buffer.hlsl");
+
     // Light buffer
     struct BufferLight
     {
@@ -0,0 +1,218 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+//= INCLUDES ===============================
+#include "Spartan.h"
+#include "Renderer.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+#include "../World/World.h"
+#include "../World/Entity.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Light.h"
+//==========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    void Renderer::RenderablesCull()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        // Every frustum that needs a visible list, the camera first and then every slice of every shadow casting light
+        struct CullView
+        {
+            const Frustum* frustum;
+            bool ignore_near_plane;
+            bool shadow_casters_only;
+        };
+        vector<CullView> views;
+        views.push_back({ &m_camera->GetFrustum(), false, false });
+
+        // Gather the lights which render into shadow maps (the rest stay null so that indices match m_entities)
+        m_cull_lights.clear();
+        for (Entity* entity : m_entities[Renderer_Object_Light])
+        {
+            Light* light = entity->GetComponent<Light>();
+            const bool casts_shadows = light && light->GetShadowsEnabled() && light->GetDepthTexture();
+            m_cull_lights.emplace_back(casts_shadows ? light : nullptr);
+
+            for (uint32_t slice_index = 0; casts_shadows && slice_index < light->GetShadowArraySize(); slice_index++)
+            {
+                views.push_back({ &light->GetFrustum(slice_index), light->GetFrustumIgnoresNearPlane(), true });
+            }
+        }
+
+        // Each view gets a bit array per object type, a bit per entity
+        const uint32_t word_count_opaque        = (static_cast<uint32_t>(m_entities[Renderer_Object_Opaque].size()) + 31) / 32;
+        const uint32_t word_count_transparent   = (static_cast<uint32_t>(m_entities[Renderer_Object_Transparent].size()) + 31) / 32;
+        const uint32_t word_count_view          = word_count_opaque + word_count_transparent;
+        m_cull_visibility.assign(static_cast<size_t>(word_count_view) * views.size(), 0);
+
+        // Keys encode the object type in the top bit and the index in m_entities in the rest
+        const auto set_visible = [word_count_opaque](uint32_t* visibility, const uint32_t key)
+        {
+            const uint32_t index = key & ~cull_key_transparent;
+            const uint32_t word  = (key & cull_key_transparent ? word_count_opaque : 0) + index / 32;
+            visibility[word]    |= 1u << (index % 32);
+        };
+
+        // The world keeps renderables in a bounding volume hierarchy, so whole regions are rejected (or accepted) at once.
+        // Views are independent of each other, so every view is queried by a single thread, and the boxes which straddle
+        // its frustum are kept as candidates for an exact test.
+        m_cull_candidates.resize(views.size());
+        const World* world = m_context->GetSubsystem<World>();
+        m_threading->AddTaskLoop([this, &views, world, &set_visible, word_count_view](uint32_t view_start, uint32_t view_end)
+        {
+            for (uint32_t view_index = view_start; view_index < view_end; view_index++)
+            {
+                const CullView& view        = views[view_index];
+                uint32_t* visibility        = &m_cull_visibility[static_cast<size_t>(view_index) * word_count_view];
+                CullCandidates& candidates  = m_cull_candidates[view_index];
+
+                candidates.keys.clear();
+                candidates.boxes.Resize(0);
+                const auto visit = [this, &view, &set_visible, visibility, &candidates](void* user_data, const BoundingBox& box, const bool contained)
+                {
+                    // Only entities which the renderer acquired (active ones)
+                    Entity* entity              = static_cast<Entity*>(user_data);
+                    const uint32_t handle_index = entity->GetHandle().index;
+                    if (handle_index >= static_cast<uint32_t>(m_cull_keys.size()) || m_cull_keys[handle_index] == cull_key_none)
+                        return;
+
+                    if (view.shadow_casters_only)
+                    {
+                        Renderable* renderable = entity->GetRenderable();
+                        if (!renderable || !renderable->GetCastShadows())
+                            return;
+                    }
+
+                    const uint32_t key = m_cull_keys[handle_index];
+                    if (contained)
+                    {
+                        set_visible(visibility, key);
+                    }
+                    else
+                    {
+                        candidates.boxes.Add(box.GetCenter(), box.GetExtents());
+                        candidates.keys.emplace_back(key);
+                    }
+                };
+                world->BvhRead([&view, &visit](const BoundingVolumeHierarchy& bvh) { bvh.Query(*view.frustum, view.ignore_near_plane, visit); });
+
+                candidates.visibility.assign((candidates.boxes.Size() + 31) / 32, 0);
+            }
+        }, static_cast<uint32_t>(views.size()), 1);
+
+        // The candidates get an exact test in SIMD batches. The batches of all views are spread across threads together,
+        // so that the camera view isn't culled by a single thread when there are no shadow casting lights.
+        struct CullBatch
+        {
+            uint32_t view_index;
+            uint32_t start;
+            uint32_t end;
+        };
+        vector<CullBatch> batches;
+        for (uint32_t view_index = 0; view_index < static_cast<uint32_t>(views.size()); view_index++)
+        {
+            const uint32_t candidate_count = m_cull_candidates[view_index].boxes.Size();
+            for (uint32_t start = 0; start < candidate_count; start += cull_batch_size)
+            {
+                batches.push_back({ view_index, start, Helper::Min(start + cull_batch_size, candidate_count) });
+            }
+        }
+
+        m_threading->AddTaskLoop([this, &views, &batches](uint32_t batch_start, uint32_t batch_end)
+        {
+            for (uint32_t batch_index = batch_start; batch_index < batch_end; batch_index++)
+            {
+                const CullBatch& batch      = batches[batch_index];
+                const CullView& view        = views[batch.view_index];
+                CullCandidates& candidates  = m_cull_candidates[batch.view_index];
+
+                view.frustum->IsVisible(candidates.boxes, batch.start, batch.end, candidates.visibility.data(), view.ignore_near_plane);
+            }
+        }, static_cast<uint32_t>(batches.size()), 1);
+
+        // Merge the candidates which passed into the visibility of their view
+        m_threading->AddTaskLoop([this, &set_visible, word_count_view](uint32_t view_start, uint32_t view_end)
+        {
+            for (uint32_t view_index = view_start; view_index < view_end; view_index++)
+            {
+                uint32_t* visibility                = &m_cull_visibility[static_cast<size_t>(view_index) * word_count_view];
+                const CullCandidates& candidates    = m_cull_candidates[view_index];
+
+                for (uint32_t i = 0; i < static_cast<uint32_t>(candidates.keys.size()); i++)
+                {
+                    if (candidates.visibility[i / 32] & (1u << (i % 32)))
+                    {
+                        set_visible(visibility, candidates.keys[i]);
+                    }
+                }
+            }
+        }, static_cast<uint32_t>(views.size()), 1);
+
+        // Compact into the visible lists, in order
+        const auto compact = [this](const uint32_t* visibility, const Renderer_Object_Type object_type, vector<Entity*>& visible)
+        {
+            const vector<Entity*>& entities = m_entities[object_type];
+            const uint32_t word_count       = (static_cast<uint32_t>(entities.size()) + 31) / 32;
+
+            visible.clear();
+            for (uint32_t word = 0; word < word_count; word++)
+            {
+                for (uint32_t bits = visibility[word], bit = 0; bits != 0; bits >>= 1, bit++)
+                {
+                    if (bits & 1)
+                    {
+                        visible.emplace_back(entities[word * 32 + bit]);
+                    }
+                }
+            }
+        };
+
+        const uint32_t light_count = static_cast<uint32_t>(m_cull_lights.size());
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            const uint32_t* visibility = &m_cull_visibility[object_type == Renderer_Object_Transparent ? word_count_opaque : 0];
+            compact(visibility, object_type, m_entities_visible[object_type]);
+
+            vector<vector<vector<Entity*>>>& visible_lights = m_entities_visible_light[object_type];
+            visible_lights.resize(light_count);
+            for (uint32_t light_index = 0; light_index < light_count; light_index++)
+            {
+                const Light* light = m_cull_lights[light_index];
+                visible_lights[light_index].resize(light ? light->GetShadowArraySize() : 0);
+
+                for (vector<Entity*>& visible_slice : visible_lights[light_index])
+                {
+                    visibility += word_count_view;
+                    compact(visibility, object_type, visible_slice);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,256 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES ===============================
+#include "Spartan.h"
+#include "Renderer.h"
+#include "Model.h"
+#include "../Profiling/Profiler.h"
+#include "../Threading/Threading.h"
+#include "../World/Entity.h"
+#include "../World/Components/Renderable.h"
+#include "../World/Components/Camera.h"
+#include "../World/Components/Transform.h"
+#include "../World/Components/Light.h"
+//==========================================
+
+//= NAMESPACES ===============
+using namespace std;
+using namespace Spartan::Math;
+//============================
+
+namespace Spartan
+{
+    void Renderer::DrawPacketsBuild()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        const Vector3 camera_position = m_camera->GetTransform()->GetPosition();
+
+        for (const Renderer_Object_Type object_type : { Renderer_Object_Opaque, Renderer_Object_Transparent })
+        {
+            DrawPacketsBuild(m_entities_visible[object_type], m_draw_packets[object_type], camera_position, object_type == Renderer_Object_Transparent);
+
+            // Shadow casters, with the same shape as the visible lists (the light's position is just for the depth ordering)
+            const vector<vector<vector<Entity*>>>& visible_lights  = m_entities_visible_light[object_type];
+            vector<vector<vector<DrawPacket>>>& packets_lights      = m_draw_packets_light[object_type];
+            packets_lights.resize(visible_lights.size());
+            for (uint32_t light_index = 0; light_index < static_cast<uint32_t>(visible_lights.size()); light_index++)
+            {
+                const Light* light = m_cull_lights[light_index];
+                packets_lights[light_index].resize(visible_lights[light_index].size());
+
+                for (uint32_t slice_index = 0; slice_index < static_cast<uint32_t>(visible_lights[light_index].size()); slice_index++)
+                {
+                    const Vector3 light_position = light ? light->GetTransform()->GetPosition() : camera_position;
+                    DrawPacketsBuild(visible_lights[light_index][slice_index], packets_lights[light_index][slice_index], light_position, object_type == Renderer_Object_Transparent);
+                }
+            }
+        }
+    }
+
+    void Renderer::DrawPacketsBuild(const vector<Entity*>& entities, vector<DrawPacket>& packets, const Vector3& eye_position, const bool is_transparent)
+    {
+        // Depth is quantized over the camera's range, closer is smaller so that ties in state draw front to back
+        const float far_plane   = m_camera->GetFarPlane();
+        const float depth_scale = far_plane > 0.0f ? 65535.0f / far_plane : 0.0f;
+
+        // Ids only have to be unique within a list, so they are remapped to small ones (zero means none)
+        const auto id_compact = [this](const uint64_t id) -> uint64_t
+        {
+            const uint32_t id_compact = m_draw_ids.emplace(id, static_cast<uint32_t>(m_draw_ids.size()) + 1).first->second;
+            return id_compact < 0xFFFF ? id_compact : 0xFFFF;
+        };
+
+        m_draw_packets_unsorted.clear();
+        m_draw_keys.clear();
+        m_draw_ids.clear();
+        m_draw_instance_counts.clear();
+
+        for (Entity* entity : entities)
+        {
+            Renderable* renderable = entity->GetRenderable();
+            if (!renderable)
+                continue;
+
+            const Model* model = renderable->GeometryModel();
+            if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
+                continue;
+
+            // Skip transparent objects that won't contribute
+            Material* material = renderable->GetMaterial();
+            if (is_transparent && material && material->GetColorAlbedo().w == 0.0f)
+                continue;
+
+            const float depth           = (renderable->GetAabb().GetCenter() - eye_position).Length() * depth_scale;
+            const uint64_t depth_key    = depth < 65535.0f ? static_cast<uint64_t>(depth) : 0xFFFF;
+
+            // A model's buffers hold all of its meshes, so a mesh is the model and where its indices start
+            const uint64_t mesh_id = (static_cast<uint64_t>(model->GetId()) << 32) | renderable->GeometryIndexOffset();
+
+            uint64_t key = 0;
+            key |= static_cast<uint64_t>(material ? material->GetFlags() & 0x7FFF : 0) << 48;
+            key |= (material ? id_compact(material->GetId()) : 0) << 32;
+            key |= id_compact(mesh_id) << 16;
+            key |= depth_key;
+
+            m_draw_instance_counts[static_cast<uint32_t>(key >> 16)]++;
+            m_draw_keys.push_back({ key, static_cast<uint32_t>(m_draw_packets_unsorted.size()) });
+            m_draw_packets_unsorted.push_back({ entity, renderable, material, model, false });
+        }
+
+        // Meshes which are drawn more than once with the same material are instanced. The top bit of the key puts
+        // them after the rest, so a pass only has to switch to the instanced vertex shader once.
+        for (DrawKey& draw_key : m_draw_keys)
+        {
+            if (m_draw_instance_counts[static_cast<uint32_t>(draw_key.key >> 16)] > 1)
+            {
+                draw_key.key |= 1ull << 63;
+                m_draw_packets_unsorted[draw_key.index].instanced = true;
+            }
+        }
+
+        DrawKeysSort();
+
+        packets.clear();
+        packets.reserve(m_draw_keys.size());
+        for (const DrawKey& draw_key : m_draw_keys)
+        {
+            packets.emplace_back(m_draw_packets_unsorted[draw_key.index]);
+        }
+    }
+
+    uint32_t Renderer::DrawPacketsInstanceCount(const vector<DrawPacket>& packets, const uint32_t index)
+    {
+        const DrawPacket& first = packets[index];
+        if (!first.instanced)
+            return 1;
+
+        // Packets are sorted by material and mesh, so the instances of a mesh are next to each other
+        uint32_t count = 1;
+        while (index + count < static_cast<uint32_t>(packets.size()) && count < max_instances)
+        {
+            const DrawPacket& packet = packets[index + count];
+
+            const bool same_mesh =
+                packet.instanced                                                        &&
+                packet.model                            == first.model                  &&
+                packet.material                         == first.material               &&
+                packet.renderable->GeometryIndexOffset()  == first.renderable->GeometryIndexOffset()  &&
+                packet.renderable->GeometryIndexCount()   == first.renderable->GeometryIndexCount()   &&
+                packet.renderable->GeometryVertexOffset() == first.renderable->GeometryVertexOffset();
+
+            if (!same_mesh)
+                break;
+
+            count++;
+        }
+
+        return count;
+    }
+
+    void Renderer::DrawKeysSort()
+    {
+        // Least significant digit radix sort, 8 bits at a time, which is stable and linear in the number of keys.
+        // Large inputs are split into chunks which get counted and scattered by different threads, the prefix sum
+        // runs over digits first and chunks second, so every chunk writes into its own ranges and order is kept.
+        const uint32_t count = static_cast<uint32_t>(m_draw_keys.size());
+        if (count < 2)
+            return;
+
+        const uint32_t chunk_count  = count >= draw_keys_parallel_threshold ? m_threading->GetThreadCount() + 1 : 1;
+        const uint32_t chunk_size   = (count + chunk_count - 1) / chunk_count;
+        vector<array<uint32_t, 256>> histograms(chunk_count);
+        m_draw_keys_scratch.resize(count);
+
+        const auto for_each_chunk = [this, chunk_count](const function<void(uint32_t chunk)>& work)
+        {
+            if (chunk_count == 1)
+            {
+                work(0);
+                return;
+            }
+
+            m_threading->AddTaskLoop([&work](uint32_t chunk_start, uint32_t chunk_end)
+            {
+                for (uint32_t chunk = chunk_start; chunk < chunk_end; chunk++)
+                {
+                    work(chunk);
+                }
+            }, chunk_count, 1);
+        };
+
+        for (uint32_t shift = 0; shift < 64; shift += 8)
+        {
+            const vector<DrawKey>& keys_in  = m_draw_keys;
+            vector<DrawKey>& keys_out       = m_draw_keys_scratch;
+
+            for_each_chunk([&histograms, &keys_in, chunk_size, count, shift](const uint32_t chunk)
+            {
+                array<uint32_t, 256>& histogram = histograms[chunk];
+                histogram.fill(0);
+
+                const uint32_t end = (chunk + 1) * chunk_size < count ? (chunk + 1) * chunk_size : count;
+                for (uint32_t i = chunk * chunk_size; i < end; i++)
+                {
+                    histogram[(keys_in[i].key >> shift) & 0xFF]++;
+                }
+            });
+
+            // Skip digits which are the same for every key (common for the upper state bits)
+            const uint32_t digit_first  = (keys_in[0].key >> shift) & 0xFF;
+            uint32_t digit_first_count  = 0;
+            for (const array<uint32_t, 256>& histogram : histograms)
+            {
+                digit_first_count += histogram[digit_first];
+            }
+
+            if (digit_first_count == count)
+                continue;
+
+            // Counts to offsets
+            uint32_t offset = 0;
+            for (uint32_t digit = 0; digit < 256; digit++)
+            {
+                for (array<uint32_t, 256>& histogram : histograms)
+                {
+                    const uint32_t digit_count = histogram[digit];
+                    histogram[digit] = offset;
+                    offset += digit_count;
+                }
+            }
+
+            for_each_chunk([&histograms, &keys_in, &keys_out, chunk_size, count, shift](const uint32_t chunk)
+            {
+                array<uint32_t, 256>& offsets = histograms[chunk];
+
+                const uint32_t end = (chunk + 1) * chunk_size < count ? (chunk + 1) * chunk_size : count;
+                for (uint32_t i = chunk * chunk_size; i < end; i++)
+                {
+                    keys_out[offsets[(keys_in[i].key >> shift) & 0xFF]++] = keys_in[i];
+                }
+            });
+
+            m_draw_keys.swap(m_draw_keys_scratch);
+        }
+    }
+}
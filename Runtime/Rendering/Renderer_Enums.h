@@ -87,8 +87,10 @@ namespace Spartan
     enum class RendererShader
     {
         Gbuffer_V,
+        Gbuffer_Instanced_V,
         Gbuffer_P,
         Depth_V,
+        Depth_Instanced_V,
         Depth_P,
         Quad_V,
         Texture_P,
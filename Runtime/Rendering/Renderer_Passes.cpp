@@ -56,6 +56,7 @@ namespace Spartan
         cmd_list->SetConstantBuffer(2, RHI_Shader_Vertex | RHI_Shader_Pixel | RHI_Shader_Compute, m_buffer_uber_gpu);
         cmd_list->SetConstantBuffer(3, RHI_Shader_Vertex | RHI_Shader_Compute, m_buffer_object_gpu);
         cmd_list->SetConstantBuffer(4, RHI_Shader_Compute, m_buffer_light_gpu);
+        cmd_list->SetConstantBuffer(5, RHI_Shader_Vertex, m_buffer_instance_gpu);
         
         // Samplers
         cmd_list->SetSampler(0, m_sampler_compare_depth);
@@ -164,14 +165,14 @@ namespace Spartan
         // Transparent objects, read the opaque depth but don't write their own, instead, they write their color information using a pixel shader.
 
         // Acquire shader
-        RHI_Shader* shader_v = m_shaders[RendererShader::Depth_V].get();
-        RHI_Shader* shader_p = m_shaders[RendererShader::Depth_P].get();
+        RHI_Shader* shader_v            = m_shaders[RendererShader::Depth_V].get();
+        RHI_Shader* shader_v_instanced  = m_shaders[RendererShader::Depth_Instanced_V].get();
+        RHI_Shader* shader_p            = m_shaders[RendererShader::Depth_P].get();
         if (!shader_v->IsCompiled() || !shader_p->IsCompiled())
             return;
 
         // Get entities
-        const auto& entities = m_entities[object_type];
-        if (entities.empty())
+        if (m_entities[object_type].empty())
             return;
 
         const bool transparent_pass = object_type == Renderer_Object_Transparent;
@@ -198,7 +199,6 @@ namespace Spartan
 
             // Set render state
             static RHI_PipelineState pipeline_state;
-            pipeline_state.shader_vertex                    = shader_v;
             pipeline_state.vertex_buffer_stride             = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
             pipeline_state.shader_pixel                     = transparent_pass ? shader_p : nullptr;
             pipeline_state.blend_state                      = transparent_pass ? m_blend_alpha.get() : m_blend_disabled.get();
@@ -237,38 +237,54 @@ namespace Spartan
 
                 // State tracking
                 bool render_pass_active     = false;
+                bool instanced_active       = false;
                 uint32_t m_set_material_id  = 0;
+                pipeline_state.shader_vertex = shader_v;
 
-                for (uint32_t entity_index = 0; entity_index < static_cast<uint32_t>(entities.size()); entity_index++)
-                {
-                    Entity* entity = entities[entity_index];
+                // Packets visible to this slice (culled by RenderablesCull(), sorted by DrawPacketsBuild())
+                const auto& packets_visible = m_draw_packets_light[object_type];
+                if (light_index >= packets_visible.size() || array_index >= packets_visible[light_index].size())
+                    continue;
+                const vector<DrawPacket>& packets = packets_visible[light_index][array_index];
 
-                    // Acquire renderable component
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+                for (uint32_t index = 0, instance_count = 0; index < static_cast<uint32_t>(packets.size()); index += instance_count)
+                {
+                    const DrawPacket& packet    = packets[index];
+                    Material* material          = packet.material;
+                    instance_count              = DrawPacketsInstanceCount(packets, index);
 
-                    // Skip meshes that don't cast shadows
-                    if (!renderable->GetCastShadows())
+                    if (!material)
                         continue;
 
-                    // Acquire geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+                    // Instanced packets come last, they need their own vertex shader and therefore a render pass which loads what the first one did
+                    if (packet.instanced && !instanced_active)
+                    {
+                        if (!shader_v_instanced->IsCompiled())
+                            break;
 
-                    // Acquire material
-                    const auto& material = renderable->GetMaterial();
-                    if (!material)
-                        continue;
+                        if (render_pass_active)
+                        {
+                            cmd_list->EndRenderPass();
+                            render_pass_active              = false;
+                            pipeline_state.clear_color[0]   = rhi_color_load;
+                            pipeline_state.clear_depth      = rhi_depth_load;
+                        }
 
-                    // Skip objects outside of the view frustum
-                    if (!light->IsInViewFrustrum(renderable, array_index))
-                        continue;
+                        pipeline_state.shader_vertex    = shader_v_instanced;
+                        instanced_active                = true;
+                        m_set_material_id               = 0;
+                    }
 
                     if (!render_pass_active)
                     {
                         render_pass_active = cmd_list->BeginRenderPass(pipeline_state);
+
+                        // Instances carry just their world transform
+                        if (instanced_active)
+                        {
+                            m_buffer_uber_cpu.transform = view_projection;
+                            UpdateUberBuffer(cmd_list);
+                        }
                     }
 
                     // Bind material
@@ -290,15 +306,29 @@ namespace Spartan
                     }
 
                     // Bind geometry
-                    cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                    cmd_list->SetBufferVertex(model->GetVertexBuffer());
+                    cmd_list->SetBufferIndex(packet.model->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(packet.model->GetVertexBuffer());
 
-                    // Update uber buffer with cascade transform
-                    m_buffer_object_cpu.object = entity->GetTransform()->GetMatrix() * view_projection;
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
+                    // Update object (or instance) buffer with cascade transform
+                    if (instanced_active)
+                    {
+                        for (uint32_t i = 0; i < instance_count; i++)
+                        {
+                            m_buffer_instance_cpu.instances[i].transform = packets[index + i].entity->GetTransform()->GetMatrix();
+                        }
 
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                        if (!UpdateInstanceBuffer(cmd_list, instance_count))
+                            continue;
+                    }
+                    else
+                    {
+                        m_buffer_object_cpu.object = packet.entity->GetTransform()->GetMatrix() * view_projection;
+                        if (!UpdateObjectBuffer(cmd_list))
+                            continue;
+                    }
+
+                    cmd_list->DrawIndexed(packet.renderable->GeometryIndexCount(), packet.renderable->GeometryIndexOffset(), packet.renderable->GeometryVertexOffset(), instance_count);
+                    m_profiler->m_renderer_draw_calls++;
                 }
 
                 if (render_pass_active)
@@ -315,9 +345,10 @@ namespace Spartan
         // just their depth information into a depth map.
 
         // Acquire required resources/data
-        const auto& shader_depth    = m_shaders[RendererShader::Depth_V];
-        const auto& tex_depth       = m_render_targets[RendererRt::Gbuffer_Depth];
-        const auto& entities        = m_entities[Renderer_Object_Opaque];
+        RHI_Shader* shader_depth            = m_shaders[RendererShader::Depth_V].get();
+        RHI_Shader* shader_depth_instanced  = m_shaders[RendererShader::Depth_Instanced_V].get();
+        const auto& tex_depth               = m_render_targets[RendererRt::Gbuffer_Depth];
+        const auto& packets                 = m_draw_packets[Renderer_Object_Opaque];
 
         // Ensure the shader has compiled
         if (!shader_depth->IsCompiled())
@@ -325,62 +356,78 @@ namespace Spartan
 
         // Set render state
         static RHI_PipelineState pipeline_state;
-        pipeline_state.shader_vertex                = shader_depth.get();
+        pipeline_state.vertex_buffer_stride         = static_cast<uint32_t>(sizeof(RHI_Vertex_PosTexNorTan)); // assume all vertex buffers have the same stride (which they do)
         pipeline_state.shader_pixel                 = nullptr;
         pipeline_state.rasterizer_state             = m_rasterizer_cull_back_solid.get();
         pipeline_state.blend_state                  = m_blend_disabled.get();
         pipeline_state.depth_stencil_state          = m_depth_stencil_on_off_w.get();
         pipeline_state.render_target_depth_texture  = tex_depth.get();
-        pipeline_state.clear_depth                  = GetClearDepth();
         pipeline_state.viewport                     = tex_depth->GetViewport();
         pipeline_state.primitive_topology           = RHI_PrimitiveTopology_TriangleList;
-        pipeline_state.pass_name                    = "Pass_DepthPrePass";
 
-        // Record commands
-        if (cmd_list->BeginRenderPass(pipeline_state))
-        { 
-            if (!entities.empty())
-            {
-                // Variables that help reduce state changes
-                uint32_t currently_bound_geometry = 0;
+        // Packets which are not instanced come first and then the instanced ones, each is a render pass
+        // with its own vertex shader (the first one always runs, so that the depth gets cleared).
+        uint32_t index = 0;
+        for (const bool instanced : { false, true })
+        {
+            if (instanced && (index == static_cast<uint32_t>(packets.size()) || !shader_depth_instanced->IsCompiled()))
+                break;
 
-                // Draw opaque
-                for (const auto& entity : entities)
-                {
-                    // Get renderable
-                    const auto& renderable = entity->GetRenderable();
-                    if (!renderable)
-                        continue;
+            pipeline_state.shader_vertex    = instanced ? shader_depth_instanced : shader_depth;
+            pipeline_state.clear_depth      = instanced ? rhi_depth_load : GetClearDepth();
+            pipeline_state.pass_name        = instanced ? "Pass_DepthPrePass_Instanced" : "Pass_DepthPrePass";
 
-                    // Get geometry
-                    const auto& model = renderable->GeometryModel();
-                    if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                        continue;
+            // Record commands
+            if (!cmd_list->BeginRenderPass(pipeline_state))
+                return;
 
-                    // Skip objects outside of the view frustum
-                    if (!m_camera->IsInViewFrustrum(renderable))
-                        continue;
+            // Instances carry just their world transform
+            if (instanced)
+            {
+                m_buffer_uber_cpu.transform = m_buffer_frame_cpu.view_projection;
+                UpdateUberBuffer(cmd_list);
+            }
 
-                    // Bind geometry
-                    if (currently_bound_geometry != model->GetId())
-                    {
-                        cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                        cmd_list->SetBufferVertex(model->GetVertexBuffer());
-                        currently_bound_geometry = model->GetId();
-                    }
+            // Variables that help reduce state changes
+            uint32_t currently_bound_geometry = 0;
+
+            // Draw opaque (packets are sorted by mesh and then depth, within each material)
+            for (uint32_t instance_count = 0; index < static_cast<uint32_t>(packets.size()) && packets[index].instanced == instanced; index += instance_count)
+            {
+                const DrawPacket& packet    = packets[index];
+                instance_count              = DrawPacketsInstanceCount(packets, index);
 
-                    // Update uber buffer with entity transform
-                    if (Transform* transform = entity->GetTransform())
+                // Bind geometry
+                if (currently_bound_geometry != packet.model->GetId())
+                {
+                    cmd_list->SetBufferIndex(packet.model->GetIndexBuffer());
+                    cmd_list->SetBufferVertex(packet.model->GetVertexBuffer());
+                    currently_bound_geometry = packet.model->GetId();
+                }
+
+                // Update object (or instance) buffer with the transform
+                if (instanced)
+                {
+                    for (uint32_t i = 0; i < instance_count; i++)
                     {
-                        // Update uber buffer with cascade transform
-                        m_buffer_uber_cpu.transform = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                        UpdateUberBuffer(cmd_list);
+                        m_buffer_instance_cpu.instances[i].transform = packets[index + i].entity->GetTransform()->GetMatrix();
                     }
 
-                    // Draw    
-                    cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
+                    if (!UpdateInstanceBuffer(cmd_list, instance_count))
+                        continue;
                 }
+                else
+                {
+                    m_buffer_object_cpu.object = packet.entity->GetTransform()->GetMatrix() * m_buffer_frame_cpu.view_projection;
+                    if (!UpdateObjectBuffer(cmd_list))
+                        continue;
+                }
+
+                // Draw
+                cmd_list->DrawIndexed(packet.renderable->GeometryIndexCount(), packet.renderable->GeometryIndexOffset(), packet.renderable->GeometryVertexOffset(), instance_count);
+                m_profiler->m_renderer_draw_calls++;
             }
+
             cmd_list->EndRenderPass();
         }
     }
@@ -388,13 +435,14 @@ namespace Spartan
     void Renderer::Pass_GBuffer(RHI_CommandList* cmd_list, const bool is_transparent_pass /*= false*/)
     {
         // Acquire required resources/shaders
-        RHI_Texture* tex_albedo       = m_render_targets[RendererRt::Gbuffer_Albedo].get();
-        RHI_Texture* tex_normal       = m_render_targets[RendererRt::Gbuffer_Normal].get();
-        RHI_Texture* tex_material     = m_render_targets[RendererRt::Gbuffer_Material].get();
-        RHI_Texture* tex_velocity     = m_render_targets[RendererRt::Gbuffer_Velocity].get();
-        RHI_Texture* tex_depth        = m_render_targets[RendererRt::Gbuffer_Depth].get();
-        RHI_Shader* shader_v          = m_shaders[RendererShader::Gbuffer_V].get();
-        ShaderGBuffer* shader_p       = static_cast<ShaderGBuffer*>(m_shaders[RendererShader::Gbuffer_P].get());
+        RHI_Texture* tex_albedo        = m_render_targets[RendererRt::Gbuffer_Albedo].get();
+        RHI_Texture* tex_normal        = m_render_targets[RendererRt::Gbuffer_Normal].get();
+        RHI_Texture* tex_material      = m_render_targets[RendererRt::Gbuffer_Material].get();
+        RHI_Texture* tex_velocity      = m_render_targets[RendererRt::Gbuffer_Velocity].get();
+        RHI_Texture* tex_depth         = m_render_targets[RendererRt::Gbuffer_Depth].get();
+        RHI_Shader* shader_v           = m_shaders[RendererShader::Gbuffer_V].get();
+        RHI_Shader* shader_v_instanced = m_shaders[RendererShader::Gbuffer_Instanced_V].get();
+        ShaderGBuffer* shader_p        = static_cast<ShaderGBuffer*>(m_shaders[RendererShader::Gbuffer_P].get());
 
         // Validate that the shader has compiled
         if (!shader_v->IsCompiled())
@@ -421,144 +469,157 @@ namespace Spartan
         pso.viewport                        = tex_albedo->GetViewport();
         pso.primitive_topology              = RHI_PrimitiveTopology_TriangleList;
 
-        bool cleared = false;
-        uint32_t material_index = 0;
-        uint32_t material_bound_id = 0;
+        bool cleared                = false;
+        bool render_pass_active     = false;
+        bool shader_set             = false;
+        bool shader_instanced       = false;
+        uint16_t shader_flags       = 0;
+        uint32_t material_index     = 0;
+        uint32_t material_bound_id  = 0;
         m_material_instances.fill(nullptr);
 
-        // Iterate through all the G-Buffer shader variations
-        for (const auto& it : ShaderGBuffer::GetVariations())
+        // Packets are sorted by instancing and shader variation first, so every variation is a single render pass
+        const vector<DrawPacket>& packets = m_draw_packets[is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque];
+        for (uint32_t index = 0, instance_count = 0; index < static_cast<uint32_t>(packets.size()); index += instance_count)
         {
-            // Skip the shader until it compiles or the users spots a compilation error
-            if (!it.second->IsCompiled())
-                continue;
-
-            // Set pixel shader
-            pso.shader_pixel = static_cast<RHI_Shader*>(it.second.get());
+            const DrawPacket& packet    = packets[index];
+            Renderable* renderable      = packet.renderable;
+            Material* material          = packet.material;
+            const Model* model          = packet.model;
+            instance_count              = DrawPacketsInstanceCount(packets, index);
 
-            // Set pass name
-            pso.pass_name = pso.shader_pixel->GetName().c_str();
-
-            bool render_pass_active = false;
-            auto& entities = m_entities[is_transparent_pass ? Renderer_Object_Transparent : Renderer_Object_Opaque];
+            if (!material)
+                continue;
 
-            // Record commands
-            for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+            // Switch shaders
+            if (!shader_set || material->GetFlags() != shader_flags || packet.instanced != shader_instanced)
             {
-                Entity* entity = entities[i];
+                shader_flags        = material->GetFlags();
+                shader_instanced    = packet.instanced;
+                shader_set          = true;
 
-                // Get renderable
-                const auto& renderable = entity->GetRenderable();
-                if (!renderable)
-                    continue;
-
-                // Get material
-                Material* material = renderable->GetMaterial();
-                if (!material)
-                    continue;
+                if (render_pass_active)
+                {
+                    cmd_list->EndRenderPass();
+                    render_pass_active = false;
+                }
 
-                // Skip objects with different shader requirements
-                if (!static_cast<ShaderGBuffer*>(pso.shader_pixel)->IsSuitable(material->GetFlags()))
+                // Skip the shaders until they compile or the users spots a compilation error
+                RHI_Shader* shader_vertex   = shader_instanced ? shader_v_instanced : shader_v;
+                const auto& variations      = ShaderGBuffer::GetVariations();
+                const auto it               = variations.find(shader_flags);
+                if (!shader_vertex->IsCompiled() || it == variations.end() || !it->second->IsCompiled())
                     continue;
 
-                // Skip transparent objects that won't contribute
-                if (material->GetColorAlbedo().w == 0 && is_transparent_pass)
-                    continue;
+                // Set shaders
+                pso.shader_vertex   = shader_vertex;
+                pso.shader_pixel    = static_cast<RHI_Shader*>(it->second.get());
 
-                // Get geometry
-                const auto& model = renderable->GeometryModel();
-                if (!model || !model->GetVertexBuffer() || !model->GetIndexBuffer())
-                    continue;
+                // Set pass name
+                pso.pass_name = pso.shader_pixel->GetName().c_str();
 
-                // Skip objects outside of the view frustum
-                if (!m_camera->IsInViewFrustrum(renderable))
-                    continue;
+                render_pass_active = cmd_list->BeginRenderPass(pso);
 
-                if (!render_pass_active)
+                // Clear only on first pass
+                if (render_pass_active && !cleared)
                 {
-                    render_pass_active = cmd_list->BeginRenderPass(pso);
+                    pso.ResetClearValues();
+                    cleared = true;
                 }
+            }
 
-                // Set geometry (will only happen if not already set)
-                cmd_list->SetBufferIndex(model->GetIndexBuffer());
-                cmd_list->SetBufferVertex(model->GetVertexBuffer());
+            if (!render_pass_active)
+                continue;
 
-                // Bind material
-                const bool firs_run       = material_index == 0;
-                const bool new_material   = material_bound_id != material->GetId();
-                if (firs_run || new_material)
-                {
-                    material_bound_id = material->GetId();
+            // Set geometry (will only happen if not already set)
+            cmd_list->SetBufferIndex(model->GetIndexBuffer());
+            cmd_list->SetBufferVertex(model->GetVertexBuffer());
 
-                    // Keep track of used material instances (they get mapped to shaders)
-                    if (material_index + 1 < m_material_instances.size())
-                    {
-                        // Advance index (0 is reserved for the sky)
-                        material_index++;
+            // Bind material
+            const bool firs_run       = material_index == 0;
+            const bool new_material   = material_bound_id != material->GetId();
+            if (firs_run || new_material)
+            {
+                material_bound_id = material->GetId();
 
-                        // Keep reference
-                        m_material_instances[material_index] = material;
-                    }
-                    else
-                    {
-                        LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
-                    }
+                // Keep track of used material instances (they get mapped to shaders)
+                if (material_index + 1 < m_material_instances.size())
+                {
+                    // Advance index (0 is reserved for the sky)
+                    material_index++;
 
-                    // Bind material textures        
-                    cmd_list->SetTexture(RendererBindingsSrv::material_albedo, material->GetTexture_Ptr(Material_Color));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_roughness, material->GetTexture_Ptr(Material_Roughness));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_metallic, material->GetTexture_Ptr(Material_Metallic));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_normal, material->GetTexture_Ptr(Material_Normal));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_height, material->GetTexture_Ptr(Material_Height));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_occlusion, material->GetTexture_Ptr(Material_Occlusion));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_emission, material->GetTexture_Ptr(Material_Emission));
-                    cmd_list->SetTexture(RendererBindingsSrv::material_mask, material->GetTexture_Ptr(Material_Mask));
-                
-                    // Update uber buffer with material properties
-                    m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
-                    m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
-                    m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
-                    m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
-                    m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
-                    m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
-                    m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
-                    m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
-
-                    // Update constant buffer
-                    UpdateUberBuffer(cmd_list);
+                    // Keep reference
+                    m_material_instances[material_index] = material;
                 }
-                
-                // Update uber buffer with entity transform
-                if (Transform* transform = entity->GetTransform())
+                else
                 {
-                    m_buffer_object_cpu.object          = transform->GetMatrix();
-                    m_buffer_object_cpu.wvp_current     = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
-                    m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
-
-                    // Save matrix for velocity computation
-                    transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
-
-                    // Update object buffer
-                    if (!UpdateObjectBuffer(cmd_list))
-                        continue;
+                    LOG_ERROR("Material instance array has reached it's maximum capacity of %d elements. Consider increasing the size.", m_max_material_instances);
                 }
-                
-                // Render    
-                cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset());
-                m_profiler->m_renderer_meshes_rendered++;
 
-                // Clear only on first pass
-                if (!cleared)
+                // Bind material textures        
+                cmd_list->SetTexture(RendererBindingsSrv::material_albedo, material->GetTexture_Ptr(Material_Color));
+                cmd_list->SetTexture(RendererBindingsSrv::material_roughness, material->GetTexture_Ptr(Material_Roughness));
+                cmd_list->SetTexture(RendererBindingsSrv::material_metallic, material->GetTexture_Ptr(Material_Metallic));
+                cmd_list->SetTexture(RendererBindingsSrv::material_normal, material->GetTexture_Ptr(Material_Normal));
+                cmd_list->SetTexture(RendererBindingsSrv::material_height, material->GetTexture_Ptr(Material_Height));
+                cmd_list->SetTexture(RendererBindingsSrv::material_occlusion, material->GetTexture_Ptr(Material_Occlusion));
+                cmd_list->SetTexture(RendererBindingsSrv::material_emission, material->GetTexture_Ptr(Material_Emission));
+                cmd_list->SetTexture(RendererBindingsSrv::material_mask, material->GetTexture_Ptr(Material_Mask));
+            
+                // Update uber buffer with material properties
+                m_buffer_uber_cpu.mat_id            = static_cast<float>(material_index);
+                m_buffer_uber_cpu.mat_albedo        = material->GetColorAlbedo();
+                m_buffer_uber_cpu.mat_tiling_uv     = material->GetTiling();
+                m_buffer_uber_cpu.mat_offset_uv     = material->GetOffset();
+                m_buffer_uber_cpu.mat_roughness_mul = material->GetProperty(Material_Roughness);
+                m_buffer_uber_cpu.mat_metallic_mul  = material->GetProperty(Material_Metallic);
+                m_buffer_uber_cpu.mat_normal_mul    = material->GetProperty(Material_Normal);
+                m_buffer_uber_cpu.mat_height_mul    = material->GetProperty(Material_Height);
+
+                // Update constant buffer
+                UpdateUberBuffer(cmd_list);
+            }
+            
+            // Update object (or instance) buffer with entity transform
+            if (packet.instanced)
+            {
+                for (uint32_t i = 0; i < instance_count; i++)
                 {
-                    pso.ResetClearValues();
-                    cleared = true;
+                    Transform* transform                = packets[index + i].entity->GetTransform();
+                    BufferInstance::Instance& instance  = m_buffer_instance_cpu.instances[i];
+                    instance.transform                  = transform->GetMatrix();
+                    instance.wvp_previous               = transform->GetWvpLastFrame();
+
+                    // Save matrix for velocity computation
+                    transform->SetWvpLastFrame(instance.transform * m_buffer_frame_cpu.view_projection);
                 }
-            }
 
-            if (render_pass_active)
+                if (!UpdateInstanceBuffer(cmd_list, instance_count))
+                    continue;
+            }
+            else if (Transform* transform = packet.entity->GetTransform())
             {
-                cmd_list->EndRenderPass();
+                m_buffer_object_cpu.object          = transform->GetMatrix();
+                m_buffer_object_cpu.wvp_current     = transform->GetMatrix() * m_buffer_frame_cpu.view_projection;
+                m_buffer_object_cpu.wvp_previous    = transform->GetWvpLastFrame();
+
+                // Save matrix for velocity computation
+                transform->SetWvpLastFrame(m_buffer_object_cpu.wvp_current);
+
+                // Update object buffer
+                if (!UpdateObjectBuffer(cmd_list))
+                    continue;
             }
+            
+            // Render    
+            cmd_list->DrawIndexed(renderable->GeometryIndexCount(), renderable->GeometryIndexOffset(), renderable->GeometryVertexOffset(), instance_count);
+            m_profiler->m_renderer_meshes_rendered += instance_count;
+            m_profiler->m_renderer_draw_calls++;
+        }
+
+        if (render_pass_active)
+        {
+            cmd_list->EndRenderPass();
         }
     }
 
@@ -45,22 +45,27 @@ namespace Spartan
 {
     void Renderer::CreateConstantBuffers()
     {
+        // Dynamic buffers are partitioned per frame in flight, so the offset counts are slots per frame times the frame count.
+        // These are starting points, a buffer grows whenever a frame needs more.
         bool is_dynamic = true;
 
         m_buffer_frame_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "frame", is_dynamic);
-        m_buffer_frame_gpu->Create<BufferFrame>(m_swap_chain_buffer_count);
+        m_buffer_frame_gpu->Create<BufferFrame>(m_swap_chain_buffer_count * 4);
 
         m_buffer_material_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "material", is_dynamic);
-        m_buffer_material_gpu->Create<BufferMaterial>(m_swap_chain_buffer_count);
+        m_buffer_material_gpu->Create<BufferMaterial>(m_swap_chain_buffer_count * 4);
 
         m_buffer_uber_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "uber", is_dynamic);
-        m_buffer_uber_gpu->Create<BufferUber>(64);
+        m_buffer_uber_gpu->Create<BufferUber>(m_swap_chain_buffer_count * 64);
 
         m_buffer_object_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "object", is_dynamic);
-        m_buffer_object_gpu->Create<BufferObject>(m_swap_chain_buffer_count);
+        m_buffer_object_gpu->Create<BufferObject>(m_swap_chain_buffer_count * 256);
 
         m_buffer_light_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "light", is_dynamic);
-        m_buffer_light_gpu->Create<BufferLight>(m_swap_chain_buffer_count);
+        m_buffer_light_gpu->Create<BufferLight>(m_swap_chain_buffer_count * 16);
+
+        m_buffer_instance_gpu = make_shared<RHI_ConstantBuffer>(m_rhi_device, "instance", is_dynamic);
+        m_buffer_instance_gpu->Create<BufferInstance>(m_swap_chain_buffer_count * 16);
     }
 
     void Renderer::CreateDepthStencilStates()
@@ -191,6 +196,9 @@ namespace Spartan
         // G-Buffer
         m_shaders[RendererShader::Gbuffer_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Gbuffer_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
+        m_shaders[RendererShader::Gbuffer_Instanced_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Gbuffer_Instanced_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Gbuffer_Instanced_V]->CompileAsync<RHI_Vertex_PosTexNorTan>(RHI_Shader_Vertex, dir_shaders + "GBuffer.hlsl");
 
         // Quad
         {
@@ -206,6 +214,9 @@ namespace Spartan
         // Depth Vertex
         m_shaders[RendererShader::Depth_V] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Depth_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
+        m_shaders[RendererShader::Depth_Instanced_V] = make_shared<RHI_Shader>(m_context);
+        m_shaders[RendererShader::Depth_Instanced_V]->AddDefine("INSTANCED");
+        m_shaders[RendererShader::Depth_Instanced_V]->CompileAsync<RHI_Vertex_PosTex>(RHI_Shader_Vertex, dir_shaders + "Depth.hlsl");
         m_shaders[RendererShader::Depth_P] = make_shared<RHI_Shader>(m_context);
         m_shaders[RendererShader::Depth_P]->CompileAsync(RHI_Shader_Pixel, dir_shaders + "Depth.hlsl");
 
@@ -29,6 +29,8 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../World/World.h"
 #include "../World/Entity.h"
 #include "../IO/FileStream.h"
+#include "../Utilities/Hash.h"
+#include "../Threading/Threading.h"
 #include "../RHI/RHI_Texture2D.h"
 #include "../RHI/RHI_TextureCube.h"
 #include "../Audio/AudioClip.h"
@@ -57,6 +59,7 @@ namespace Spartan
 
         // Create project directory
         SetProjectDirectory("Project/");
+        SetDerivedDataDirectory(m_project_directory + "derived_data/");
 
         // Subscribe to events
         SUBSCRIBE_TO_EVENT(EventType::WorldSave,    EVENT_HANDLER(SaveResourcesToFiles));
@@ -88,46 +91,416 @@ namespace Spartan
             return false;
         }
 
-        for (const auto& resource : m_resource_groups[resource_type])
-        {
-            if (resource_name == resource->GetResourceName())
-                return true;
-        }
+        return GetByName(resource_name, resource_type) != nullptr;
+    }
 
-        return false;
+    shared_ptr<IResource> ResourceCache::GetByName(const string& name, const ResourceType type)
+    {
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        const auto group = m_resource_groups.find(type);
+        if (group == m_resource_groups.end())
+            return nullptr;
+
+        const auto it = group->second.index_name.find(name);
+        return it != group->second.index_name.end() ? group->second.resources[it->second] : nullptr;
     }
 
-    shared_ptr<IResource>& ResourceCache::GetByName(const string& name, const ResourceType type)
+    shared_ptr<IResource> ResourceCache::GetByPath(const string& path, const ResourceType type)
     {
-        for (auto& resource : m_resource_groups[type])
-        {
-            if (name == resource->GetResourceName())
-                return resource;
-        }
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        const auto group = m_resource_groups.find(type);
+        if (group == m_resource_groups.end())
+            return nullptr;
 
-        static shared_ptr<IResource> empty;
-        return empty;
+        const auto it = group->second.index_path.find(path);
+        return it != group->second.index_path.end() ? group->second.resources[it->second] : nullptr;
+    }
+
+    shared_ptr<IResource> ResourceCache::GetById(const uint32_t id)
+    {
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        const auto it = m_resources_by_id.find(id);
+        return it != m_resources_by_id.end() ? it->second : nullptr;
     }
 
     vector<shared_ptr<IResource>> ResourceCache::GetByType(const ResourceType type /*= ResourceType::Unknown*/)
     {
         vector<shared_ptr<IResource>> resources;
 
+        shared_lock<shared_mutex> lock(m_mutex);
+
         if (type == ResourceType::Unknown)
         {
             for (const auto& resource_group : m_resource_groups)
             {
-                resources.insert(resources.end(), resource_group.second.begin(), resource_group.second.end());
+                resources.insert(resources.end(), resource_group.second.resources.begin(), resource_group.second.resources.end());
             }
         }
         else
         {
-            resources = m_resource_groups[type];
+            const auto group = m_resource_groups.find(type);
+            if (group != m_resource_groups.end())
+            {
+                resources = group->second.resources;
+            }
         }
 
         return resources;
     }
 
+    shared_ptr<IResource> ResourceCache::Insert(const shared_ptr<IResource>& resource, bool* inserted)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        // The check and the insertion happen under the same lock, so two threads can't cache the same resource
+        ResourceGroup& group = m_resource_groups[resource->GetResourceType()];
+        const auto it = group.index_name.emplace(resource->GetResourceName(), static_cast<uint32_t>(group.resources.size()));
+        if (!it.second)
+        {
+            *inserted = false;
+            return group.resources[it.first->second];
+        }
+
+        group.index_path.emplace(resource->GetResourceFilePathNative(), it.first->second);
+        group.resources.emplace_back(resource);
+        group.residency.push_back({ m_frame, resource->GetSizeCpu(), resource->GetSizeGpu() });
+        group.size_cpu += resource->GetSizeCpu();
+        group.size_gpu += resource->GetSizeGpu();
+        m_resources_by_id[resource->GetId()] = resource;
+
+        *inserted = true;
+        return resource;
+    }
+
+    void ResourceCache::Remove(IResource* resource)
+    {
+        shared_ptr<IResource> removed; // released after unlocking
+        {
+            unique_lock<shared_mutex> lock(m_mutex);
+
+            const auto group_it = m_resource_groups.find(resource->GetResourceType());
+            if (group_it == m_resource_groups.end())
+                return;
+
+            ResourceGroup& group = group_it->second;
+            const auto it = group.index_name.find(resource->GetResourceName());
+            if (it == group.index_name.end() || group.resources[it->second].get() != resource)
+                return;
+
+            removed = Erase(group, it->second);
+        }
+    }
+
+    void ResourceCache::RemoveIfUnreferenced(const shared_ptr<IResource>& resource)
+    {
+        shared_ptr<IResource> removed; // released after unlocking
+        {
+            unique_lock<shared_mutex> lock(m_mutex);
+
+            const auto group_it = m_resource_groups.find(resource->GetResourceType());
+            if (group_it == m_resource_groups.end())
+                return;
+
+            ResourceGroup& group = group_it->second;
+            const auto it = group.index_name.find(resource->GetResourceName());
+            if (it == group.index_name.end() || group.resources[it->second] != resource)
+                return;
+
+            // The group, the id index and the caller hold a reference each, anything more is someone using it
+            if (resource.use_count() > 3)
+                return;
+
+            removed = Erase(group, it->second);
+        }
+    }
+
+    shared_ptr<IResource> ResourceCache::Erase(ResourceGroup& group, const uint32_t index)
+    {
+        shared_ptr<IResource> resource = move(group.resources[index]);
+
+        group.index_name.erase(resource->GetResourceName());
+        group.index_path.erase(resource->GetResourceFilePathNative());
+        group.size_cpu -= group.residency[index].size_cpu;
+        group.size_gpu -= group.residency[index].size_gpu;
+        m_resources_by_id.erase(resource->GetId());
+
+        // Swap with the last resource and pop, the moved resource gets its indices patched
+        const uint32_t index_last = static_cast<uint32_t>(group.resources.size()) - 1;
+        if (index != index_last)
+        {
+            shared_ptr<IResource>& last = group.resources[index_last];
+            group.index_name[last->GetResourceName()]           = index;
+            group.index_path[last->GetResourceFilePathNative()] = index;
+            group.resources[index]                              = move(last);
+            group.residency[index]                              = group.residency[index_last];
+        }
+        group.resources.pop_back();
+        group.residency.pop_back();
+
+        return resource;
+    }
+
+    void ResourceCache::Tick(float delta_time)
+    {
+        // The totals are kept as resources come and go, so without a budget there is nothing to do
+        if (!m_budget_set)
+            return;
+
+        // Unreferenced resources of the groups which are over budget, least recently used first
+        struct Candidate
+        {
+            uint64_t frame_used;
+            string name;
+            const IResource* resource; // only compared, it may be gone by the time the exclusive lock is taken
+        };
+        vector<pair<ResourceType, vector<Candidate>>> over_budget;
+
+        // Marking which resources are in use only needs the shared lock, the tick is the only writer of m_frame and
+        // of the frames in the residency, and everything else which touches them takes the exclusive lock.
+        {
+            shared_lock<shared_mutex> lock(m_mutex);
+
+            m_frame++;
+
+            for (auto& group_it : m_resource_groups)
+            {
+                ResourceGroup& group = group_it.second;
+                if (group.budget_cpu == 0 && group.budget_gpu == 0)
+                    continue;
+
+                // A resource which is referenced by anything else than the cache (the group and the id index hold a reference each) is in use
+                for (uint32_t i = 0; i < static_cast<uint32_t>(group.resources.size()); i++)
+                {
+                    if (group.resources[i].use_count() > 2)
+                    {
+                        group.residency[i].frame_used = m_frame;
+                    }
+                }
+
+                if (!IsOverBudget(group))
+                    continue;
+
+                vector<Candidate> candidates;
+                for (uint32_t i = 0; i < static_cast<uint32_t>(group.resources.size()); i++)
+                {
+                    if (group.residency[i].frame_used != m_frame)
+                    {
+                        candidates.push_back({ group.residency[i].frame_used, group.resources[i]->GetResourceName(), group.resources[i].get() });
+                    }
+                }
+                sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) { return a.frame_used < b.frame_used; });
+
+                over_budget.emplace_back(group_it.first, move(candidates));
+            }
+        }
+
+        if (over_budget.empty())
+            return;
+
+        // Evicted resources are released after unlocking, as their destruction can reach back into the cache
+        vector<shared_ptr<IResource>> evicted;
+        {
+            unique_lock<shared_mutex> lock(m_mutex);
+
+            for (const auto& group_candidates : over_budget)
+            {
+                const auto group_it = m_resource_groups.find(group_candidates.first);
+                if (group_it == m_resource_groups.end())
+                    continue;
+
+                ResourceGroup& group = group_it->second;
+                for (const Candidate& candidate : group_candidates.second)
+                {
+                    if (!IsOverBudget(group))
+                        break;
+
+                    // Indices move as resources are erased, and between the locks a candidate can be removed, or referenced again
+                    const auto it = group.index_name.find(candidate.name);
+                    if (it == group.index_name.end() || group.resources[it->second].get() != candidate.resource || group.resources[it->second].use_count() > 2)
+                        continue;
+
+                    evicted.emplace_back(Erase(group, it->second));
+                }
+
+                if (IsOverBudget(group))
+                {
+                    LOG_WARNING("The resources of type %d which are in use exceed the memory budget", static_cast<int>(group_candidates.first));
+                }
+            }
+        }
+
+        for (const auto& resource : evicted)
+        {
+            LOG_INFO("Evicted \"%s\"", resource->GetResourceName().c_str());
+        }
+    }
+
+    bool ResourceCache::IsOverBudget(const ResourceGroup& group)
+    {
+        return (group.budget_cpu != 0 && group.size_cpu > group.budget_cpu) || (group.budget_gpu != 0 && group.size_gpu > group.budget_gpu);
+    }
+
+    void ResourceCache::SetMemoryBudget(const ResourceType type, const uint64_t budget_cpu, const uint64_t budget_gpu)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        ResourceGroup& group    = m_resource_groups[type];
+        group.budget_cpu        = budget_cpu;
+        group.budget_gpu        = budget_gpu;
+
+        m_budget_set = any_of(m_resource_groups.begin(), m_resource_groups.end(), [](const auto& group_it) { return group_it.second.budget_cpu != 0 || group_it.second.budget_gpu != 0; });
+    }
+
+    void ResourceCache::ResourceSizeChanged(const IResource* resource)
+    {
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        const auto group_it = m_resource_groups.find(resource->GetResourceType());
+        if (group_it == m_resource_groups.end())
+            return;
+
+        ResourceGroup& group = group_it->second;
+        const auto it = group.index_name.find(resource->GetResourceName());
+        if (it == group.index_name.end() || group.resources[it->second].get() != resource)
+            return;
+
+        Residency& residency    = group.residency[it->second];
+        group.size_cpu          = group.size_cpu - residency.size_cpu + resource->GetSizeCpu();
+        group.size_gpu          = group.size_gpu - residency.size_gpu + resource->GetSizeGpu();
+        residency.size_cpu      = resource->GetSizeCpu();
+        residency.size_gpu      = resource->GetSizeGpu();
+    }
+
+    void ResourceCache::Clear()
+    {
+        // Pending loads belong to what's being cleared
+        LoadCancel();
+
+        unique_lock<shared_mutex> lock(m_mutex);
+
+        // The budgets remain
+        for (auto& group_it : m_resource_groups)
+        {
+            ResourceGroup& group = group_it.second;
+            group.resources.clear();
+            group.residency.clear();
+            group.index_name.clear();
+            group.index_path.clear();
+            group.size_cpu = 0;
+            group.size_gpu = 0;
+        }
+        m_resources_by_id.clear();
+    }
+
+    shared_future<shared_ptr<IResource>> ResourceCache::LoadQueue(const string& key, const Resource_Priority priority, function<shared_ptr<IResource>(bool* inserted)>&& load)
+    {
+        shared_future<shared_ptr<IResource>> future;
+        {
+            lock_guard<mutex> lock(m_load_mutex);
+
+            // A resource which is already on its way is not requested again, but a more important request raises its priority
+            const auto it = key.empty() ? m_load_in_flight.end() : m_load_in_flight.find(key);
+            if (it != m_load_in_flight.end())
+            {
+                for (LoadRequest& request : m_load_queue)
+                {
+                    if (request.key == key && request.priority < priority)
+                    {
+                        request.priority = priority;
+                    }
+                }
+
+                return it->second;
+            }
+
+            LoadRequest& request    = m_load_queue.emplace_back();
+            request.key             = key;
+            request.priority        = priority;
+            request.generation      = m_load_generation;
+            request.load            = move(load);
+            future                  = request.promise.get_future().share();
+            if (!key.empty())
+            {
+                m_load_in_flight[key] = future;
+            }
+        }
+
+        // One task per request, which loads whatever is most important by the time it runs
+        m_context->GetSubsystem<Threading>()->AddTask([this]() { LoadNext(); });
+
+        return future;
+    }
+
+    void ResourceCache::LoadNext()
+    {
+        LoadRequest request;
+        {
+            lock_guard<mutex> lock(m_load_mutex);
+
+            // Cancelled
+            if (m_load_queue.empty())
+                return;
+
+            // The highest priority, and the oldest among equals
+            auto next = m_load_queue.begin();
+            for (auto it = m_load_queue.begin(); it != m_load_queue.end(); it++)
+            {
+                if (it->priority > next->priority)
+                {
+                    next = it;
+                }
+            }
+
+            request = move(*next);
+            m_load_queue.erase(next);
+        }
+
+        bool inserted = false;
+        shared_ptr<IResource> resource = request.load(&inserted);
+
+        {
+            lock_guard<mutex> lock(m_load_mutex);
+
+            // If the world was unloaded in the meantime, the resource belongs to it and is dropped. It's only evicted if this
+            // load is what cached it, and if the new world hasn't picked it up from the cache since (e.g. through Load()).
+            if (request.generation != m_load_generation)
+            {
+                if (resource && inserted)
+                {
+                    RemoveIfUnreferenced(resource);
+                }
+                resource = nullptr;
+            }
+            else
+            {
+                m_load_in_flight.erase(request.key);
+            }
+        }
+
+        request.promise.set_value(resource);
+    }
+
+    void ResourceCache::LoadCancel()
+    {
+        vector<LoadRequest> cancelled;
+        {
+            lock_guard<mutex> lock(m_load_mutex);
+
+            m_load_generation++;
+            cancelled.swap(m_load_queue);
+            m_load_in_flight.clear();
+        }
+
+        // Whoever is waiting gets nothing
+        for (LoadRequest& request : cancelled)
+        {
+            request.promise.set_value(nullptr);
+        }
+    }
+
     void ResourceCache::SaveResourcesToFiles()
     {
         // Start progress report
@@ -144,30 +517,28 @@ namespace Spartan
             return;
         }
 
-        const auto resource_count = GetResourceCount();
+        // Only resources with a native file can be restored (a copy of the list, as saving can reach back into the cache)
+        vector<shared_ptr<IResource>> resources = GetByType();
+        resources.erase(remove_if(resources.begin(), resources.end(), [](const shared_ptr<IResource>& resource) { return !resource->HasFilePathNative(); }), resources.end());
+
+        const auto resource_count = static_cast<uint32_t>(resources.size());
         ProgressReport::Get().SetJobCount(g_progress_resource_cache, resource_count);
 
         // Save resource count
         file->Write(resource_count);
 
         // Save all the currently used resources to disk
-        for (const auto& resource_group : m_resource_groups)
+        for (const auto& resource : resources)
         {
-            for (const auto& resource : resource_group.second)
-            {
-                if (!resource->HasFilePathNative())
-                    continue;
-
-                // Save file path
-                file->Write(resource->GetResourceFilePathNative());
-                // Save type
-                file->Write(static_cast<uint32_t>(resource->GetResourceType()));
-                // Save resource (to a dedicated file)
-                resource->SaveToFile(resource->GetResourceFilePathNative());
-
-                // Update progress
-                ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
-            }
+            // Save file path
+            file->Write(resource->GetResourceFilePathNative());
+            // Save type
+            file->Write(static_cast<uint32_t>(resource->GetResourceType()));
+            // Save resource (to a dedicated file)
+            resource->SaveToFile(resource->GetResourceFilePathNative());
+
+            // Update progress
+            ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
         }
 
         // Finish with progress report
@@ -181,67 +552,87 @@ namespace Spartan
         auto file = make_unique<FileStream>(file_path, FileStream_Read);
         if (!file->IsOpen())
             return;
-        
+
         // Load resource count
         const auto resource_count = file->ReadAs<uint32_t>();
 
+        // Resources reference each other through the cache, so they are restored in stages: textures and audio first,
+        // then the materials which reference the textures, and then the models which reference the materials.
+        vector<pair<string, ResourceType>> stages[3];
         for (uint32_t i = 0; i < resource_count; i++)
         {
             // Load resource file path
-            auto file_path = file->ReadAs<string>();
+            auto resource_path = file->ReadAs<string>();
 
             // Load resource type
             const auto type = static_cast<ResourceType>(file->ReadAs<uint32_t>());
 
-            switch (type)
-            {
-            case ResourceType::Model:
-                Load<Model>(file_path);
-                break;
-            case ResourceType::Material:
-                Load<Material>(file_path);
-                break;
-            case ResourceType::Texture:
-                Load<RHI_Texture>(file_path);
-                break;
-            case ResourceType::Texture2d:
-                Load<RHI_Texture2D>(file_path);
-                break;
-            case ResourceType::TextureCube:
-                Load<RHI_TextureCube>(file_path);
-                break;
-            case ResourceType::Audio:
-                Load<AudioClip>(file_path);
-                break;
-            }
+            const uint32_t stage = type == ResourceType::Model ? 2 : type == ResourceType::Material ? 1 : 0;
+            stages[stage].emplace_back(move(resource_path), type);
         }
-    }
+        file->Close();
 
-    uint64_t ResourceCache::GetMemoryUsageCpu(ResourceType type /*= Resource_Unknown*/)
-    {
-        uint64_t size = 0;
+        // Start progress report
+        ProgressReport::Get().Reset(g_progress_resource_cache);
+        ProgressReport::Get().SetIsLoading(g_progress_resource_cache, true);
+        ProgressReport::Get().SetStatus(g_progress_resource_cache, "Loading resources...");
+        ProgressReport::Get().SetJobCount(g_progress_resource_cache, resource_count);
 
-        if (type == ResourceType::Unknown)
+        // The resources of a stage don't depend on each other, so they load in parallel
+        Threading* threading = m_context->GetSubsystem<Threading>();
+        for (const auto& stage : stages)
         {
-            for (const auto& group : m_resource_groups)
+            threading->AddTaskLoop([this, &stage](uint32_t start, uint32_t end)
             {
-                for (const auto& resource : group.second)
+                for (uint32_t i = start; i < end; i++)
                 {
-                    if (Spartan_Object* object = dynamic_cast<Spartan_Object*>(resource.get()))
+                    const string& resource_path = stage[i].first;
+
+                    switch (stage[i].second)
                     {
-                        size += object->GetSizeCpu();
+                    case ResourceType::Model:
+                        Load<Model>(resource_path);
+                        break;
+                    case ResourceType::Material:
+                        Load<Material>(resource_path);
+                        break;
+                    case ResourceType::Texture:
+                        Load<RHI_Texture>(resource_path);
+                        break;
+                    case ResourceType::Texture2d:
+                        Load<RHI_Texture2D>(resource_path);
+                        break;
+                    case ResourceType::TextureCube:
+                        Load<RHI_TextureCube>(resource_path);
+                        break;
+                    case ResourceType::Audio:
+                        Load<AudioClip>(resource_path);
+                        break;
                     }
                 }
+            }, static_cast<uint32_t>(stage.size()), 1);
+
+            // Not thread safe, so it's reported here
+            for (size_t i = 0; i < stage.size(); i++)
+            {
+                ProgressReport::Get().IncrementJobsDone(g_progress_resource_cache);
             }
         }
-        else
+
+        // Finish with progress report
+        ProgressReport::Get().SetIsLoading(g_progress_resource_cache, false);
+    }
+
+    uint64_t ResourceCache::GetMemoryUsageCpu(ResourceType type /*= Resource_Unknown*/)
+    {
+        shared_lock<shared_mutex> lock(m_mutex);
+
+        uint64_t size = 0;
+        for (const auto& group : m_resource_groups)
         {
-            for (const auto& resource : m_resource_groups[type])
+            if (type == ResourceType::Unknown || type == group.first)
             {
-                if (Spartan_Object* object = dynamic_cast<Spartan_Object*>(resource.get()))
-                {
-                    size += object->GetSizeCpu();
-                }
+                size += group.second.size_cpu;
             }
         }
 
@@ -250,13 +641,14 @@ namespace Spartan
 
     uint64_t ResourceCache::GetMemoryUsageGpu(ResourceType type /*= Resource_Unknown*/)
     {
-        uint64_t size = 0;
+        shared_lock<shared_mutex> lock(m_mutex);
 
-        for (const auto& resource : m_resource_groups[type])
+        uint64_t size = 0;
+        for (const auto& group : m_resource_groups)
         {
-            if (Spartan_Object* object = dynamic_cast<Spartan_Object*>(resource.get()))
+            if (type == ResourceType::Unknown || type == group.first)
             {
-                size += object->GetSizeGpu();
+                size += group.second.size_gpu;
             }
         }
 
@@ -298,4 +690,37 @@ namespace Spartan
     {
         return FileSystem::GetWorkingDirectory() + "/" + m_project_directory;
     }
+
+    void ResourceCache::SetDerivedDataDirectory(const string& directory)
+    {
+        if (!directory.empty() && !FileSystem::Exists(directory))
+        {
+            FileSystem::CreateDirectory_(directory);
+        }
+
+        m_derived_data_directory = directory;
+    }
+
+    string ResourceCache::GetDerivedDataFilePath(const string& file_path, const uint64_t settings, const string& extension)
+    {
+        if (m_derived_data_directory.empty())
+            return "";
+
+        FileStream file(file_path, FileStream_Read);
+        if (!file.IsOpen())
+            return "";
+
+        const std::byte* bytes = file.ReadView(file.GetSize());
+        if (!bytes)
+            return "";
+
+        // The content and the settings, not the path, so that the same source imports once wherever it lives
+        uint64_t hash = Utility::Hash::fnv1a_64(bytes, file.GetSize());
+        hash          = Utility::Hash::fnv1a_64(&settings, sizeof(settings), hash);
+
+        char name[17];
+        snprintf(name, sizeof(name), "%016llx", static_cast<unsigned long long>(hash));
+
+        return m_derived_data_directory + name + extension;
+    }
 }
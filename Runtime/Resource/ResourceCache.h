@@ -23,7 +23,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES ==================
 #include <unordered_map>
+#include <shared_mutex>
+#include <functional>
+#include <atomic>
 #include "IResource.h"
+#include "ResourceRequest.h"
 #include "../Core/ISubsystem.h"
 //=============================
 
@@ -51,12 +55,13 @@ namespace Spartan
         ResourceCache(Context* context);
         ~ResourceCache();
 
-        //= Subsystem =============
+        //= Subsystem =======================
         bool Initialize() override;
-        //=========================
+        void Tick(float delta_time) override;
+        //===================================
 
         // Get by name
-        std::shared_ptr<IResource>& GetByName(const std::string& name, ResourceType type);
+        std::shared_ptr<IResource> GetByName(const std::string& name, ResourceType type);
         template <class T> 
         constexpr std::shared_ptr<T> GetByName(const std::string& name) 
         { 
@@ -67,22 +72,25 @@ namespace Spartan
         std::vector<std::shared_ptr<IResource>> GetByType(ResourceType type = ResourceType::Unknown);
 
         // Get by path
+        std::shared_ptr<IResource> GetByPath(const std::string& path, ResourceType type);
         template <class T>
         std::shared_ptr<T> GetByPath(const std::string& path)
         {
-            for (auto& resource : m_resource_groups[IResource::TypeToEnum<T>()])
-            {
-                if (path == resource->GetResourceFilePathNative())
-                    return std::static_pointer_cast<T>(resource);
-            }
-
-            return nullptr;
+            return std::static_pointer_cast<T>(GetByPath(path, IResource::TypeToEnum<T>()));
         }
 
-        // Caches resource, or replaces with existing cached resource
+        // Get by id
+        std::shared_ptr<IResource> GetById(uint32_t id);
+
+        // Caches resource, or replaces with existing cached resource (inserted tells which one happened)
         template <class T>
-        [[nodiscard]] std::shared_ptr<T> Cache(const std::shared_ptr<T>& resource)
+        [[nodiscard]] std::shared_ptr<T> Cache(const std::shared_ptr<T>& resource, bool* inserted = nullptr)
         {
+            if (inserted)
+            {
+                *inserted = false;
+            }
+
             // Validate resource
             if (!resource)
                 return nullptr;
@@ -101,45 +109,43 @@ namespace Spartan
                 return nullptr;
             }
 
-            // Ensure that this resource is not already cached
-            if (IsCached(resource->GetResourceName(), resource->GetResourceType()))
-                return GetByName<T>(resource->GetResourceName());
-
-            // Prevent threads from colliding in critical section
-            std::lock_guard<mutex> guard(m_mutex);
+            // Cache it, unless a resource with the same name got there first
+            bool is_new = false;
+            std::shared_ptr<IResource> cached = Insert(resource, &is_new);
 
             // In order to guarantee deserialization, we save it now
-            resource->SaveToFile(resource->GetResourceFilePathNative());
+            if (is_new)
+            {
+                resource->SaveToFile(resource->GetResourceFilePathNative());
+            }
+
+            if (inserted)
+            {
+                *inserted = is_new;
+            }
 
-            // Cache it
-            return static_pointer_cast<T>(m_resource_groups[resource->GetResourceType()].emplace_back(resource));
+            return std::static_pointer_cast<T>(cached);
         }
         bool IsCached(const std::string& resource_name, ResourceType resource_type);
 
         template <class T>
         void Remove(std::shared_ptr<T>& resource)
         {
-            if (!resource)
-                return;
-
-            if (!IsCached(resource->GetResourceName(), resource->GetResourceType()))
-                return;
-
-            auto& vector = m_resource_groups[resource->GetResourceType()];
-            for (auto it = vector.begin(); it != vector.end(); it++)
+            if (resource)
             {
-                if (dynamic_cast<Spartan_Object*>((*it).get())->GetId() == resource->GetId())
-                {
-                    vector.erase(it);
-                    break;
-                }
+                Remove(static_cast<IResource*>(resource.get()));
             }
         }
 
-        // Loads a resource and adds it to the resource cache
+        // Loads a resource and adds it to the resource cache (inserted tells if it wasn't cached before)
         template <class T>
-        std::shared_ptr<T> Load(const std::string& file_path)
+        std::shared_ptr<T> Load(const std::string& file_path, bool* inserted = nullptr)
         {
+            if (inserted)
+            {
+                *inserted = false;
+            }
+
             if (!FileSystem::Exists(file_path))
             {
                 LOG_ERROR("\"%s\" doesn't exist.", file_path.c_str());
@@ -147,9 +153,8 @@ namespace Spartan
             }
 
             // Check if the resource is already loaded
-            const auto name = FileSystem::GetFileNameNoExtensionFromFilePath(file_path);
-            if (IsCached(name, IResource::TypeToEnum<T>()))
-                return GetByName<T>(name);
+            if (std::shared_ptr<T> cached = GetByName<T>(FileSystem::GetFileNameNoExtensionFromFilePath(file_path)))
+                return cached;
 
             // Create new resource
             auto typed = std::make_shared<T>(m_context);
@@ -165,7 +170,25 @@ namespace Spartan
             }
 
             // Returned cached reference which is guaranteed to be around after deserialization
-            return Cache<T>(typed);
+            return Cache<T>(typed, inserted);
+        }
+
+        // Loads a resource in the background (and caches it, like Load), the most important requests are loaded first.
+        // Requests for a resource (same type and file) which is already on its way share its result, and requests that are pending when the world unloads are cancelled.
+        template <class T>
+        ResourceRequest<T> LoadAsync(const std::string& file_path, const Resource_Priority priority = Resource_Priority_Normal)
+        {
+            const std::string key = std::to_string(static_cast<uint32_t>(IResource::TypeToEnum<T>())) + "|" + file_path;
+            return ResourceRequest<T>(LoadQueue(key, priority, [this, file_path](bool* inserted) { return std::static_pointer_cast<IResource>(Load<T>(file_path, inserted)); }));
+        }
+
+        // Same as above, but the resource comes from the given function (e.g. for resources which need construction options).
+        // What the function makes can't be told apart from other requests, so these are never shared.
+        template <class T>
+        ResourceRequest<T> LoadAsync(const Resource_Priority priority, std::function<std::shared_ptr<T>()>&& load)
+        {
+            // The resource isn't cached by the request, so there is nothing to undo if the request goes stale
+            return ResourceRequest<T>(LoadQueue(std::string(), priority, [load = std::move(load)](bool* inserted) { *inserted = false; return std::static_pointer_cast<IResource>(load()); }));
         }
 
         //= I/O ======================
@@ -174,11 +197,19 @@ namespace Spartan
         //============================
         
         //= MISC =============================================================
-        // Memory
+        // Memory (the totals are kept as resources are cached, removed or report a new size)
         uint64_t GetMemoryUsageCpu(ResourceType type = ResourceType::Unknown);
         uint64_t GetMemoryUsageGpu(ResourceType type = ResourceType::Unknown);
+
+        // Resources call this when their memory usage changes (e.g. a reload), it does nothing if they aren't cached
+        void ResourceSizeChanged(const IResource* resource);
+
+        // Memory budget of a type, zero means unlimited. When a type goes over budget, its resources which
+        // are no longer referenced outside of the cache are evicted (least recently used first), they can
+        // be loaded again from their native file.
+        void SetMemoryBudget(ResourceType type, uint64_t budget_cpu, uint64_t budget_gpu);
         // Unloads all resources
-        void Clear() { m_resource_groups.clear(); }
+        void Clear();
         // Returns all resources of a given type
         uint32_t GetResourceCount(ResourceType type = ResourceType::Unknown);
         //====================================================================
@@ -192,19 +223,79 @@ namespace Spartan
         std::string GetDataDirectory() const    { return "Data"; }
         //=====================================================================
 
+        //= DERIVED DATA ======================================================================================
+        // Imports of foreign files keep their processed result here, keyed by the source bytes and the import
+        // settings. The directory can be shared (e.g. between machines), so that a repeated import is a file read.
+        void SetDerivedDataDirectory(const std::string& directory);
+        const auto& GetDerivedDataDirectory() const { return m_derived_data_directory; }
+
+        // Returns where the derived data of a file with the given settings goes (it might not exist yet),
+        // or an empty string if the file can't be read or there is no derived data directory.
+        std::string GetDerivedDataFilePath(const std::string& file_path, uint64_t settings, const std::string& extension);
+        //=====================================================================================================
+
         // Importers
         auto GetModelImporter() const { return m_importer_model.get(); }
         auto GetImageImporter() const { return m_importer_image.get(); }
         auto GetFontImporter()  const { return m_importer_font.get(); }
 
     private:
-        // Cache
-        std::unordered_map<ResourceType, std::vector<std::shared_ptr<IResource>>> m_resource_groups;
-        std::mutex m_mutex;
+        std::shared_ptr<IResource> Insert(const std::shared_ptr<IResource>& resource, bool* inserted);
+        void Remove(IResource* resource);
+        void RemoveIfUnreferenced(const std::shared_ptr<IResource>& resource);
+        std::shared_future<std::shared_ptr<IResource>> LoadQueue(const std::string& key, Resource_Priority priority, std::function<std::shared_ptr<IResource>(bool* inserted)>&& load);
+        void LoadNext();
+        void LoadCancel();
+
+        // Cache, the resources of each type, hashed indices into them and their residency
+        struct Residency
+        {
+            uint64_t frame_used = 0; // the last frame the resource was referenced outside of the cache
+            uint64_t size_cpu   = 0;
+            uint64_t size_gpu   = 0;
+        };
+        struct ResourceGroup
+        {
+            std::vector<std::shared_ptr<IResource>> resources;
+            std::vector<Residency> residency; // parallel to resources
+            std::unordered_map<std::string, uint32_t> index_name;
+            std::unordered_map<std::string, uint32_t> index_path;
+            uint64_t size_cpu   = 0;
+            uint64_t size_gpu   = 0;
+            uint64_t budget_cpu = 0;
+            uint64_t budget_gpu = 0;
+        };
+
+        // Removes the resource at the index of a group (the lock must be held), and returns it so that it can be released after unlocking
+        std::shared_ptr<IResource> Erase(ResourceGroup& group, uint32_t index);
+        static bool IsOverBudget(const ResourceGroup& group);
+
+        std::unordered_map<ResourceType, ResourceGroup> m_resource_groups;
+        std::unordered_map<uint32_t, std::shared_ptr<IResource>> m_resources_by_id;
+        uint64_t m_frame                = 0;     // only advanced while a budget is set
+        std::atomic<bool> m_budget_set  = false; // without a budget, the tick has nothing to do
+
+        // Lookups can happen from any thread (e.g. world loading deserializes components in parallel), they only share the lock
+        std::shared_mutex m_mutex;
+
+        // Asynchronous loading
+        struct LoadRequest
+        {
+            std::string key; // the type and file path of the resource, empty if the request is not shared
+            Resource_Priority priority = Resource_Priority_Normal;
+            uint64_t generation        = 0;
+            std::function<std::shared_ptr<IResource>(bool* inserted)> load; // inserted tells if the resource was added to the cache by this load
+            std::promise<std::shared_ptr<IResource>> promise;
+        };
+        std::vector<LoadRequest> m_load_queue; // pending, in the order they were requested
+        std::unordered_map<std::string, std::shared_future<std::shared_ptr<IResource>>> m_load_in_flight; // by key
+        uint64_t m_load_generation = 0; // incremented on cancellation, loads of an older generation are dropped
+        std::mutex m_load_mutex;
 
         // Directories
         std::unordered_map<Asset_Type, std::string> m_standard_resource_directories;
         std::string m_project_directory;
+        std::string m_derived_data_directory;
 
         // Importers
         std::shared_ptr<ModelImporter> m_importer_model;
@@ -0,0 +1,58 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ======
+#include <future>
+#include <memory>
+//=================
+
+namespace Spartan
+{
+    class IResource;
+
+    enum Resource_Priority : uint8_t
+    {
+        Resource_Priority_Low,
+        Resource_Priority_Normal,
+        Resource_Priority_High
+    };
+
+    // The pending result of ResourceCache::LoadAsync(), the resource is nullptr if loading failed or was cancelled
+    template <class T>
+    class ResourceRequest
+    {
+    public:
+        ResourceRequest() = default;
+        ResourceRequest(const std::shared_future<std::shared_ptr<IResource>>& future) : m_future(future) {}
+
+        bool IsValid() const { return m_future.valid(); }
+        bool IsReady() const { return m_future.valid() && m_future.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+
+        // Blocks until the load has finished, so don't call it from a task (the load might be queued behind it)
+        std::shared_ptr<T> Get() const { return m_future.valid() ? std::static_pointer_cast<T>(m_future.get()) : nullptr; }
+
+    private:
+        std::shared_future<std::shared_ptr<IResource>> m_future;
+    };
+}
@@ -0,0 +1,167 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES ===================
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <new>
+#include "../Core/Spartan_Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // Tracks the completion of a group of tasks, wait on it with Threading::Wait()
+    class SPARTAN_CLASS TaskCounter
+    {
+    public:
+        TaskCounter() = default;
+        ~TaskCounter() = default;
+
+        void Increment(const uint32_t count = 1)    { m_value.fetch_add(count, std::memory_order_relaxed); }
+        void Decrement()                            { m_value.fetch_sub(1); }
+        uint32_t GetValue() const                   { return m_value.load(); }
+        bool IsDone() const                         { return GetValue() == 0; }
+
+    private:
+        std::atomic<uint32_t> m_value = 0;
+    };
+
+    // A unit of work. The callable is stored inline (no heap allocation) as long as it fits in the storage.
+    class Task
+    {
+    public:
+        static constexpr uint32_t storage_size = 64;
+
+        Task() = default;
+        ~Task() = default;
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        template <typename Function>
+        void Set(Function&& function, TaskCounter* counter)
+        {
+            using function_type = std::decay_t<Function>;
+
+            if constexpr (sizeof(function_type) <= storage_size && alignof(function_type) <= alignof(std::max_align_t))
+            {
+                new (m_storage) function_type(std::forward<Function>(function));
+                m_invoke  = [](void* storage) { (*static_cast<function_type*>(storage))(); };
+                m_destroy = [](void* storage) { static_cast<function_type*>(storage)->~function_type(); };
+            }
+            else
+            {
+                // Unusually large captures fall back to the heap
+                *reinterpret_cast<function_type**>(m_storage) = new function_type(std::forward<Function>(function));
+                m_invoke  = [](void* storage) { (**static_cast<function_type**>(storage))(); };
+                m_destroy = [](void* storage) { delete *static_cast<function_type**>(storage); };
+            }
+
+            m_counter = counter;
+        }
+
+        // Runs the callable and releases the task
+        void Execute()
+        {
+            m_invoke(m_storage);
+            Release();
+        }
+
+        // Releases the task without running it
+        void Discard() { Release(); }
+
+        const TaskCounter* GetCounter() const { return m_counter; }
+        bool IsFree() const { return m_is_free.load(std::memory_order_acquire); }
+        void Reserve()      { m_is_free.store(false, std::memory_order_relaxed); }
+
+        // Tasks which don't come from a pool delete themselves once released
+        static Task* CreateHeapAllocated()
+        {
+            Task* task = new Task();
+            task->m_is_heap_allocated = true;
+            task->Reserve();
+            return task;
+        }
+
+    private:
+        void Release()
+        {
+            m_destroy(m_storage);
+            TaskCounter* counter = m_counter;
+            m_counter = nullptr;
+
+            if (m_is_heap_allocated)
+            {
+                delete this;
+            }
+            else
+            {
+                m_is_free.store(true, std::memory_order_release);
+            }
+
+            // Signal last, a waiter is free to destroy the counter as soon as it reaches zero
+            if (counter)
+            {
+                counter->Decrement();
+            }
+        }
+
+        alignas(std::max_align_t) std::byte m_storage[storage_size];
+        void (*m_invoke)(void*)         = nullptr;
+        void (*m_destroy)(void*)        = nullptr;
+        TaskCounter* m_counter          = nullptr;
+        std::atomic<bool> m_is_free     = true;
+        bool m_is_heap_allocated        = false;
+    };
+
+    // A fixed size ring of tasks owned by a single thread, slots are recycled once their task has executed
+    template <uint32_t capacity>
+    class TaskPool
+    {
+    public:
+        static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+        // Returns the next free slot, or nullptr if every slot is still in flight
+        Task* Allocate()
+        {
+            // Slots are usually freed in order, so the next one is almost always available. The ones
+            // that aren't are typically waiting further up the stack of a thread which is helping out.
+            for (uint32_t i = 0; i < capacity; i++)
+            {
+                Task* task = &m_tasks[m_index++ & (capacity - 1)];
+                if (task->IsFree())
+                {
+                    task->Reserve();
+                    return task;
+                }
+            }
+
+            return nullptr;
+        }
+
+    private:
+        Task m_tasks[capacity];
+        uint32_t m_index = 0;
+    };
+}
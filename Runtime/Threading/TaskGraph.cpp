@@ -0,0 +1,127 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+//= INCLUDES =========
+#include "Spartan.h"
+#include "TaskGraph.h"
+//====================
+
+//= NAMESPACES =====
+using namespace std;
+//==================
+
+namespace Spartan
+{
+    uint32_t TaskGraph::AddNode(function<void()>&& function, const string& name /*= ""*/)
+    {
+        if (IsRunning())
+        {
+            LOG_ERROR("Can't modify a graph while it's running");
+            return numeric_limits<uint32_t>::max();
+        }
+
+        auto node       = make_unique<Node>();
+        node->function  = move(function);
+        node->name      = name;
+        m_nodes.emplace_back(move(node));
+
+        return static_cast<uint32_t>(m_nodes.size() - 1);
+    }
+
+    bool TaskGraph::AddEdge(const uint32_t from, const uint32_t to)
+    {
+        if (from >= m_nodes.size() || to >= m_nodes.size() || from == to)
+        {
+            LOG_ERROR_INVALID_PARAMETER();
+            return false;
+        }
+
+        if (IsRunning())
+        {
+            LOG_ERROR("Can't modify a graph while it's running");
+            return false;
+        }
+
+        m_nodes[from]->successors.emplace_back(to);
+        m_nodes[to]->dependency_count++;
+
+        return true;
+    }
+
+    uint32_t TaskGraph::AddContinuation(const vector<uint32_t>& dependencies, function<void()>&& function, const string& name /*= ""*/)
+    {
+        const uint32_t index = AddNode(move(function), name);
+        if (index == numeric_limits<uint32_t>::max())
+            return index;
+
+        for (const uint32_t dependency : dependencies)
+        {
+            AddEdge(dependency, index);
+        }
+
+        return index;
+    }
+
+    void TaskGraph::Clear()
+    {
+        if (IsRunning())
+        {
+            LOG_ERROR("Can't clear a graph while it's running");
+            return;
+        }
+
+        m_nodes.clear();
+    }
+
+    bool TaskGraph::Validate() const
+    {
+        // Kahn's algorithm, if not every node can be visited then there is a cycle
+        vector<uint32_t> dependencies(m_nodes.size());
+        vector<uint32_t> ready;
+        for (uint32_t i = 0; i < m_nodes.size(); i++)
+        {
+            dependencies[i] = m_nodes[i]->dependency_count;
+            if (dependencies[i] == 0)
+            {
+                ready.emplace_back(i);
+            }
+        }
+
+        uint32_t visited = 0;
+        while (!ready.empty())
+        {
+            const uint32_t index = ready.back();
+            ready.pop_back();
+            visited++;
+
+            for (const uint32_t successor : m_nodes[index]->successors)
+            {
+                if (--dependencies[successor] == 0)
+                {
+                    ready.emplace_back(successor);
+                }
+            }
+        }
+
+        return visited == m_nodes.size();
+    }
+}
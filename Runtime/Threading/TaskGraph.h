@@ -0,0 +1,76 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES ===================
+#include <vector>
+#include <string>
+#include <memory>
+#include <functional>
+#include "Task.h"
+#include "../Core/Spartan_Definitions.h"
+//==============================
+
+namespace Spartan
+{
+    // A set of tasks with dependencies between them. It can be built once and then executed as many times as
+    // needed via Threading::Run(), a node is scheduled as soon as all the nodes it depends on have executed.
+    class SPARTAN_CLASS TaskGraph
+    {
+    public:
+        TaskGraph() = default;
+        ~TaskGraph() = default;
+        TaskGraph(const TaskGraph&) = delete;
+        TaskGraph& operator=(const TaskGraph&) = delete;
+
+        // Adds a node and returns its index
+        uint32_t AddNode(std::function<void()>&& function, const std::string& name = "");
+        // Makes the node "to" execute after the node "from"
+        bool AddEdge(uint32_t from, uint32_t to);
+        // Adds a node which executes after all the given nodes have executed
+        uint32_t AddContinuation(const std::vector<uint32_t>& dependencies, std::function<void()>&& function, const std::string& name = "");
+        // Removes all nodes
+        void Clear();
+        // Returns false if the graph contains a cycle
+        bool Validate() const;
+
+        uint32_t GetNodeCount()             const { return static_cast<uint32_t>(m_nodes.size()); }
+        const std::string& GetNodeName(uint32_t index) const { return m_nodes[index]->name; }
+        const TaskCounter& GetCounter()     const { return m_counter; }
+        bool IsRunning()                    const { return !m_counter.IsDone(); }
+
+    private:
+        friend class Threading;
+
+        struct Node
+        {
+            std::function<void()> function;
+            std::string name;
+            std::vector<uint32_t> successors;
+            uint32_t dependency_count = 0;
+            std::atomic<uint32_t> dependencies_remaining = 0;
+        };
+
+        std::vector<std::unique_ptr<Node>> m_nodes;
+        TaskCounter m_counter;
+    };
+}
@@ -0,0 +1,126 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#pragma once
+
+//= INCLUDES =====
+#include <atomic>
+#include <array>
+#include "Task.h"
+//================
+
+namespace Spartan
+{
+    // A lock-free work-stealing deque (Chase-Lev) with a fixed capacity.
+    // The owning thread pushes and pops at the bottom (LIFO), any other thread steals from the top (FIFO).
+    // Based on "Correct and Efficient Work-Stealing for Weak Memory Models", Le et al. 2013.
+    template <uint32_t capacity>
+    class TaskQueue
+    {
+    public:
+        static_assert((capacity & (capacity - 1)) == 0, "Capacity must be a power of two");
+
+        TaskQueue()
+        {
+            for (auto& task : m_tasks)
+            {
+                task.store(nullptr, std::memory_order_relaxed);
+            }
+        }
+
+        // Owner only, returns false if the queue is full
+        bool Push(Task* task)
+        {
+            const int64_t bottom    = m_bottom.load(std::memory_order_relaxed);
+            const int64_t top       = m_top.load(std::memory_order_acquire);
+
+            if (bottom - top >= static_cast<int64_t>(capacity))
+                return false;
+
+            m_tasks[bottom & mask].store(task, std::memory_order_relaxed);
+            m_bottom.store(bottom + 1, std::memory_order_release);
+
+            return true;
+        }
+
+        // Owner only
+        Task* Pop()
+        {
+            const int64_t bottom = m_bottom.load(std::memory_order_relaxed) - 1;
+            m_bottom.store(bottom, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            int64_t top = m_top.load(std::memory_order_relaxed);
+
+            // Empty
+            if (top > bottom)
+            {
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Task* task = m_tasks[bottom & mask].load(std::memory_order_relaxed);
+
+            // Last task, race against the thieves for it
+            if (top == bottom)
+            {
+                if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                {
+                    task = nullptr;
+                }
+
+                m_bottom.store(bottom + 1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        // Any thread
+        Task* Steal()
+        {
+            int64_t top = m_top.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const int64_t bottom = m_bottom.load(std::memory_order_acquire);
+
+            if (top >= bottom)
+                return nullptr;
+
+            Task* task = m_tasks[top & mask].load(std::memory_order_acquire);
+            if (!m_top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return nullptr; // lost the race, another thread took it
+
+            return task;
+        }
+
+        bool IsEmpty() const
+        {
+            return m_bottom.load(std::memory_order_acquire) <= m_top.load(std::memory_order_acquire);
+        }
+
+    private:
+        static constexpr int64_t mask = static_cast<int64_t>(capacity) - 1;
+
+        // Keep the indices on separate cache lines, thieves hammer the top while the owner works the bottom
+        alignas(64) std::atomic<int64_t> m_top      = 0;
+        alignas(64) std::atomic<int64_t> m_bottom   = 0;
+        std::array<std::atomic<Task*>, capacity> m_tasks;
+    };
+}
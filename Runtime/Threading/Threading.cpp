@@ -30,16 +30,27 @@ using namespace std;
 
 namespace Spartan
 {
+    // The context index of the calling thread, the main thread is 0 and the workers follow
+    static const uint32_t thread_index_external = numeric_limits<uint32_t>::max();
+    static thread_local uint32_t t_thread_index = thread_index_external;
+
     Threading::Threading(Context* context) : ISubsystem(context)
     {
-        m_stopping                                = false;
+        m_stopping                              = false;
         m_thread_count_support                  = thread::hardware_concurrency();
         m_thread_count                          = m_thread_count_support - 1; // exclude the main (this) thread
         m_thread_names[this_thread::get_id()]   = "main";
 
+        // One context per worker, plus one for the main thread
+        for (uint32_t i = 0; i < m_thread_count + 1; i++)
+        {
+            m_thread_contexts.emplace_back(make_unique<ThreadContext>());
+        }
+        t_thread_index = 0;
+
         for (uint32_t i = 0; i < m_thread_count; i++)
         {
-            m_threads.emplace_back(thread(&Threading::ThreadLoop, this));
+            m_threads.emplace_back(thread(&Threading::ThreadLoop, this, i + 1));
             m_thread_names[m_threads.back().get_id()] = "worker_" + to_string(i);
         }
 
@@ -50,14 +61,11 @@ namespace Spartan
     {
         Flush(true);
 
-        // Put unique lock on task mutex.
-        unique_lock<mutex> lock(m_mutex_tasks);
-
         // Set termination flag to true.
-        m_stopping = true;
-
-        // Unlock the mutex
-        lock.unlock();
+        {
+            lock_guard<mutex> lock(m_mutex_sleep);
+            m_stopping = true;
+        }
 
         // Wake up all threads.
         m_condition_var.notify_all();
@@ -70,18 +78,59 @@ namespace Spartan
 
         // Empty worker threads.
         m_threads.clear();
+        m_thread_contexts.clear();
     }
 
     uint32_t Threading::GetThreadsAvailable() const
     {
-        uint32_t available_threads = m_thread_count;
+        const uint32_t threads_busy = m_threads_busy.load();
+        return threads_busy < m_thread_count ? m_thread_count - threads_busy : 0;
+    }
+
+    bool Threading::Run(TaskGraph& graph)
+    {
+        if (graph.IsRunning())
+        {
+            LOG_ERROR("The graph is already running");
+            return false;
+        }
+
+        if (!graph.Validate())
+        {
+            LOG_ERROR("The graph contains a cycle");
+            return false;
+        }
 
-        for (const auto& task : m_tasks)
+        for (const auto& node : graph.m_nodes)
         {
-            available_threads -= task->IsExecuting() ? 1 : 0;
+            node->dependencies_remaining.store(node->dependency_count, memory_order_relaxed);
         }
 
-        return available_threads;
+        // Hold the counter while scheduling, so that it can't reach zero before all the roots are in
+        graph.m_counter.Increment();
+        for (uint32_t i = 0; i < graph.GetNodeCount(); i++)
+        {
+            if (graph.m_nodes[i]->dependency_count == 0)
+            {
+                TaskGraphSchedule(graph, i);
+            }
+        }
+        graph.m_counter.Decrement();
+
+        return true;
+    }
+
+    void Threading::Wait(const TaskCounter& counter)
+    {
+        while (!counter.IsDone())
+        {
+            // Help out with the tasks of the counter, and if there are none left to help with, sleep until something completes.
+            // New tasks of the counter can only appear where this thread can take them if it submits them, so it doesn't wake up for submissions.
+            if (!TaskExecuteOne(&counter))
+            {
+                WaitBlock([&counter]() { return counter.IsDone(); }, false);
+            }
+        }
     }
 
     void Threading::Flush(bool removed_queued /*= false*/)
@@ -89,42 +138,253 @@ namespace Spartan
         // Clear any queued tasks
         if (removed_queued)
         {
-            m_tasks.clear();
+            // Stealing works from any thread, so drain every queue from the top
+            for (const auto& context : m_thread_contexts)
+            {
+                while (!context->queue.IsEmpty())
+                {
+                    if (Task* task = context->queue.Steal())
+                    {
+                        m_tasks_pending.fetch_sub(1);
+                        task->Discard();
+                    }
+                }
+            }
+
+            lock_guard<mutex> lock(m_mutex_external);
+            for (Task* task : m_tasks_external)
+            {
+                m_tasks_pending.fetch_sub(1);
+                task->Discard();
+            }
+            m_tasks_external.clear();
+            m_has_external_tasks = false;
         }
 
+        // Discarded tasks release their counters as well
+        NotifyWaiters();
+
         // If so, wait for them
         while (AreTasksRunning())
         {
-            std::this_thread::sleep_for(std::chrono::milliseconds(16));
+            if (!TaskExecuteOne())
+            {
+                WaitBlock([this]() { return !AreTasksRunning(); });
+            }
         }
     }
 
-    void Threading::ThreadLoop()
+    void Threading::WaitBlock(const function<bool()>& is_done, const bool wake_on_submit /*= true*/)
     {
-        shared_ptr<Task> task;
+        // Wakes up when a task completes (is_done might have changed) or, if requested, when a task gets submitted (there is work to help with).
+        // The waiter count is raised under the lock and the notifiers check it after they publish, so no wake up can be missed.
+        unique_lock<mutex> lock(m_mutex_wait);
+        m_threads_waiting.fetch_add(1);
+        m_condition_var_wait.wait(lock, [this, &is_done, wake_on_submit] { return is_done() || (wake_on_submit && m_tasks_pending.load() > 0); });
+        m_threads_waiting.fetch_sub(1);
+    }
+
+    void Threading::NotifyWaiters()
+    {
+        if (m_threads_waiting.load() > 0)
+        {
+            {
+                lock_guard<mutex> lock(m_mutex_wait);
+            }
+            m_condition_var_wait.notify_all();
+        }
+    }
+
+    void Threading::ThreadLoop(const uint32_t thread_index)
+    {
+        t_thread_index = thread_index;
+
         while (true)
         {
-            // Lock tasks mutex
-            unique_lock<mutex> lock(m_mutex_tasks);
+            if (TaskExecuteOne())
+                continue;
 
-            // Check condition on notification
-            m_condition_var.wait(lock, [this] { return !m_tasks.empty() || m_stopping; });
+            // Nothing to do, sleep until a task gets submitted
+            unique_lock<mutex> lock(m_mutex_sleep);
+            m_threads_asleep.fetch_add(1);
+            m_condition_var.wait(lock, [this] { return m_tasks_pending.load() > 0 || m_stopping; });
+            m_threads_asleep.fetch_sub(1);
 
             // If m_stopping is true, it's time to shut everything down
-            if (m_stopping && m_tasks.empty())
+            if (m_stopping && m_tasks_pending.load() <= 0)
                 return;
+        }
+    }
 
-            // Get next task in the queue.
-            task = m_tasks.front();
+    Task* Threading::TaskAllocate()
+    {
+        const uint32_t thread_index = t_thread_index;
 
-            // Remove it from the queue.
-            m_tasks.pop_front();
+        Task* task = nullptr;
+        if (thread_index != thread_index_external)
+        {
+            task = m_thread_contexts[thread_index]->pool.Allocate();
+        }
+        else
+        {
+            lock_guard<mutex> lock(m_mutex_external);
+            task = m_pool_external.Allocate();
+        }
 
-            // Unlock the mutex
-            lock.unlock();
+        // The pool is exhausted (a very deep burst of tasks), fall back to the heap rather than stall
+        return task ? task : Task::CreateHeapAllocated();
+    }
 
-            // Execute the task.
-            task->Execute();
+    void Threading::TaskSubmit(Task* task)
+    {
+        const uint32_t thread_index = t_thread_index;
+
+        // Pending before it can be taken, so that AreTasksRunning() never misses a queued task
+        m_tasks_pending.fetch_add(1);
+
+        if (thread_index != thread_index_external)
+        {
+            // The deque is full, execute in place
+            if (!m_thread_contexts[thread_index]->queue.Push(task))
+            {
+                m_threads_busy.fetch_add(1);
+                m_tasks_pending.fetch_sub(1);
+                task->Execute();
+                m_threads_busy.fetch_sub(1);
+                NotifyWaiters();
+                return;
+            }
+        }
+        else
+        {
+            lock_guard<mutex> lock(m_mutex_external);
+            m_tasks_external.emplace_back(task);
+            m_has_external_tasks = true;
+        }
+
+        // Wake up a thread, the lock guarantees that a thread which is about to sleep doesn't miss this
+        if (m_threads_asleep.load() > 0)
+        {
+            {
+                lock_guard<mutex> lock(m_mutex_sleep);
+            }
+            m_condition_var.notify_one();
+        }
+
+        // Threads blocked in Wait() or Flush() can help too
+        NotifyWaiters();
+    }
+
+    Task* Threading::TaskAcquire(const uint32_t thread_index, const TaskCounter* counter)
+    {
+        Task* task = nullptr;
+
+        // Only a task of the given counter. The ones this thread submitted are at the bottom of its own queue (the tasks of a
+        // loop are pushed back to back), anything else is left where it is, for a thread which isn't waiting on something.
+        if (counter)
+        {
+            if (thread_index != thread_index_external)
+            {
+                TaskQueue<m_queue_capacity>& queue = m_thread_contexts[thread_index]->queue;
+                task = queue.Pop();
+                if (task && task->GetCounter() != counter)
+                {
+                    // Back where it was, this can't fail as its slot was just freed and only the owner pushes
+                    queue.Push(task);
+                    task = nullptr;
+                }
+            }
+            else if (m_has_external_tasks.load())
+            {
+                lock_guard<mutex> lock(m_mutex_external);
+                const auto it = find_if(m_tasks_external.begin(), m_tasks_external.end(), [counter](const Task* task) { return task->GetCounter() == counter; });
+                if (it != m_tasks_external.end())
+                {
+                    task = *it;
+                    m_tasks_external.erase(it);
+                }
+                m_has_external_tasks = !m_tasks_external.empty();
+            }
+        }
+        // Own queue first (most recent task, likely still in cache)
+        else if (thread_index != thread_index_external)
+        {
+            task = m_thread_contexts[thread_index]->queue.Pop();
+        }
+
+        // Tasks submitted by external threads
+        if (!task && !counter && m_has_external_tasks.load())
+        {
+            lock_guard<mutex> lock(m_mutex_external);
+            if (!m_tasks_external.empty())
+            {
+                task = m_tasks_external.front();
+                m_tasks_external.pop_front();
+            }
+            m_has_external_tasks = !m_tasks_external.empty();
+        }
+
+        // Steal from the other threads (oldest task)
+        if (!task && !counter)
+        {
+            const uint32_t context_count    = static_cast<uint32_t>(m_thread_contexts.size());
+            const uint32_t context_start    = thread_index != thread_index_external ? thread_index + 1 : 0;
+            for (uint32_t i = 0; i < context_count && !task; i++)
+            {
+                const uint32_t victim_index = (context_start + i) % context_count;
+                if (victim_index == thread_index)
+                    continue;
+
+                task = m_thread_contexts[victim_index]->queue.Steal();
+            }
         }
+
+        // Busy before it stops being pending, so that AreTasksRunning() is true throughout and Flush() can't return while it's about to run
+        if (task)
+        {
+            m_threads_busy.fetch_add(1);
+            m_tasks_pending.fetch_sub(1);
+        }
+
+        return task;
+    }
+
+    void Threading::TaskGraphSchedule(TaskGraph& graph, const uint32_t node_index)
+    {
+        // Successors are scheduled before this task releases the graph counter, so the graph
+        // is only considered done once every node has executed (or was discarded by a flush).
+        AddTask([this, &graph, node_index]()
+        {
+            TaskGraph::Node* node = graph.m_nodes[node_index].get();
+
+            if (node->function)
+            {
+                node->function();
+            }
+
+            for (const uint32_t successor : node->successors)
+            {
+                if (graph.m_nodes[successor]->dependencies_remaining.fetch_sub(1, memory_order_acq_rel) == 1)
+                {
+                    TaskGraphSchedule(graph, successor);
+                }
+            }
+        }, &graph.m_counter);
+    }
+
+    bool Threading::TaskExecuteOne(const TaskCounter* counter /*= nullptr*/)
+    {
+        Task* task = TaskAcquire(t_thread_index, counter);
+        if (!task)
+            return false;
+
+        // TaskAcquire() marked the thread as busy
+        task->Execute();
+        m_threads_busy.fetch_sub(1);
+
+        // A counter might have reached zero, or all tasks might be done
+        NotifyWaiters();
+
+        return true;
     }
 }
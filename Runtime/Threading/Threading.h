@@ -26,37 +26,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <thread>
 #include <mutex>
 #include <deque>
+#include <atomic>
+#include <condition_variable>
 #include <unordered_map>
-#include <functional>
+#include "Task.h"
+#include "TaskQueue.h"
+#include "TaskGraph.h"
 #include "../Logging/Log.h"
 #include "../Core/ISubsystem.h"
 //=============================
 
 namespace Spartan
 {
-    class Task
-    {
-    public:
-        typedef std::function<void()> function_type;
-
-        Task(function_type&& function)  { m_function = std::forward<function_type>(function); }
-        void Execute()                  { m_is_executing = true; m_function(); m_is_executing = false; }
-        bool IsExecuting() const { return m_is_executing; }
-
-    private:
-        bool m_is_executing = false;
-        function_type m_function;
-    };
-
     class Threading : public ISubsystem
     {
     public:
         Threading(Context* context);
         ~Threading();
 
-        // Add a task
+        // Add a task, the counter (optional) is incremented now and decremented once the task has executed
         template <typename Function>
-        void AddTask(Function&& function)
+        void AddTask(Function&& function, TaskCounter* counter = nullptr)
         {
             if (m_threads.empty())
             {
@@ -65,75 +55,118 @@ namespace Spartan
                 return;
             }
 
-            // Lock tasks mutex
-            std::unique_lock<std::mutex> lock(m_mutex_tasks);
-
-            // Save the task
-            m_tasks.push_back(std::make_shared<Task>(std::bind(std::forward<Function>(function))));
+            if (counter)
+            {
+                counter->Increment();
+            }
 
-            // Unlock the mutex
-            lock.unlock();
+            // Acquire a task slot (tasks live in per-thread pools, so there is no allocation)
+            Task* task = TaskAllocate();
+            task->Set(std::forward<Function>(function), counter);
 
-            // Wake up a thread
-            m_condition_var.notify_one();
+            // Push it to the queue of the calling thread
+            TaskSubmit(task);
         }
 
-        // Adds a task which is a loop and executes chunks of it in parallel
+        // Adds a task which is a loop and executes chunks of it in parallel, the function receives a [start, end) range.
+        // A grain size of zero picks one that gives every thread a few chunks, so that uneven iterations even out.
         template <typename Function>
-        void AddTaskLoop(Function&& function, uint32_t range)
+        void AddTaskLoop(Function&& function, const uint32_t range, uint32_t grain_size = 0)
         {
-            uint32_t available_threads  = GetThreadsAvailable();
-            vector<bool> tasks_done     = vector<bool>(available_threads, false);
-            const uint32_t task_count   = available_threads + 1; // plus one for the current thread
+            if (range == 0)
+                return;
 
-            uint32_t start  = 0;
-            uint32_t end    = 0;
-            for (uint32_t i = 0; i < available_threads; i++)
+            if (grain_size == 0)
             {
-                start   = (range / task_count) * i;
-                end     = start + (range / task_count);
-
-                // Kick off task
-                AddTask([&function, &tasks_done, i, start, end] { function(start, end); tasks_done[i] = true; });
+                grain_size = range / ((m_thread_count + 1) * 4);
+                grain_size = grain_size != 0 ? grain_size : 1;
             }
 
-            // Do last task in the current thread
-            function(end, range);
-
-            // Wait till the threads are done
-            uint32_t tasks = 0;
-            while (tasks != tasks_done.size())
+            // Threads grab chunks until there are none left, instead of getting a fixed share
+            const uint32_t chunk_count = (range + grain_size - 1) / grain_size;
+            std::atomic<uint32_t> chunk_next = 0;
+            auto work = [&function, &chunk_next, chunk_count, grain_size, range]()
             {
-                tasks = 0;
-                for (const bool job_done : tasks_done)
+                uint32_t chunk = 0;
+                while ((chunk = chunk_next.fetch_add(1, std::memory_order_relaxed)) < chunk_count)
                 {
-                    tasks += job_done ? 1 : 0;
+                    const uint32_t start    = chunk * grain_size;
+                    const uint32_t end      = range - start > grain_size ? start + grain_size : range;
+                    function(start, end);
                 }
+            };
+
+            // The calling thread takes part, so one less helper is needed
+            TaskCounter counter;
+            const uint32_t helper_count = m_thread_count < chunk_count - 1 ? m_thread_count : chunk_count - 1;
+            for (uint32_t i = 0; i < helper_count; i++)
+            {
+                AddTask([&work] { work(); }, &counter);
             }
+
+            work();
+            Wait(counter);
         }
 
+        // Schedules the nodes of a graph as their dependencies complete, wait on it with Wait(graph.GetCounter())
+        bool Run(TaskGraph& graph);
+
+        // Waits for the counter to reach zero. In the meantime, the calling thread executes the queued tasks of the counter (only
+        // those, as anything else could take long, e.g. a model import) which it submitted itself, and blocks when there are none.
+        void Wait(const TaskCounter& counter);
+
         // Get the number of threads used
         uint32_t GetThreadCount()           const { return m_thread_count; }
         // Get the maximum number of threads the hardware supports
         uint32_t GetThreadCountSupport()    const { return m_thread_count_support; }
         // Get the number of threads which are not doing any work
         uint32_t GetThreadsAvailable()      const;
-        // Returns true if at least one task is running
-        bool AreTasksRunning()              const { return GetThreadsAvailable() != GetThreadCount(); }
+        // Returns true if at least one task is running or queued
+        bool AreTasksRunning()              const { return m_threads_busy.load() != 0 || m_tasks_pending.load() > 0; }
         // Waits for all executing (and queued if requested) tasks to finish
         void Flush(bool removed_queued = false);
 
     private:
+        static constexpr uint32_t m_queue_capacity = 1024;
+
+        // Each thread (the workers and the main thread) owns a deque and a task pool
+        struct ThreadContext
+        {
+            TaskQueue<m_queue_capacity> queue;
+            TaskPool<m_queue_capacity> pool;
+        };
+
         // This function is invoked by the threads
-        void ThreadLoop();
+        void ThreadLoop(uint32_t thread_index);
+
+        Task* TaskAllocate();
+        void TaskSubmit(Task* task);
+        Task* TaskAcquire(uint32_t thread_index, const TaskCounter* counter);
+        bool TaskExecuteOne(const TaskCounter* counter = nullptr);
+        void WaitBlock(const std::function<bool()>& is_done, bool wake_on_submit = true);
+        void NotifyWaiters();
+        void TaskGraphSchedule(TaskGraph& graph, uint32_t node_index);
 
         uint32_t m_thread_count         = 0;
         uint32_t m_thread_count_support = 0;
         std::vector<std::thread> m_threads;
-        std::deque<std::shared_ptr<Task>> m_tasks;
-        std::mutex m_mutex_tasks;
+        std::vector<std::unique_ptr<ThreadContext>> m_thread_contexts;
+        std::atomic<int32_t> m_tasks_pending    = 0;
+        std::atomic<uint32_t> m_threads_busy    = 0;
+        std::atomic<uint32_t> m_threads_asleep  = 0;
+        std::mutex m_mutex_sleep;
         std::condition_variable m_condition_var;
+        std::atomic<uint32_t> m_threads_waiting = 0;
+        std::mutex m_mutex_wait;
+        std::condition_variable m_condition_var_wait;
         std::unordered_map<std::thread::id, std::string> m_thread_names;
         bool m_stopping;
+
+        // Threads which are not owned by the system can't own a lock-free deque (single producer),
+        // so their tasks go through a shared, locked queue instead. This is the rare path.
+        TaskPool<m_queue_capacity> m_pool_external;
+        std::deque<Task*> m_tasks_external;
+        std::mutex m_mutex_external;
+        std::atomic<bool> m_has_external_tasks = false;
     };
 }
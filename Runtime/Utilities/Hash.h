@@ -29,4 +29,17 @@ namespace Spartan::Utility::Hash
         std::hash<T> hasher;
         seed ^= hasher(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
     }
+
+    // FNV-1a, unlike std::hash the result is the same across runs, compilers and machines, so it can be persisted
+    inline uint64_t fnv1a_64(const void* data, const uint64_t size, uint64_t seed = 0xcbf29ce484222325)
+    {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (uint64_t i = 0; i < size; i++)
+        {
+            seed ^= bytes[i];
+            seed *= 0x100000001b3;
+        }
+
+        return seed;
+    }
 }
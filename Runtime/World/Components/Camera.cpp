@@ -29,6 +29,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../../Input/Input.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
+#include "../../Math/TriangleBvh.h"
 //===================================
 
 //= NAMESPACES ===============
@@ -182,33 +183,23 @@ namespace Spartan
         Vector3 ray_end     = Unproject(mouse_position_relative);
         m_ray               = Ray(ray_start, ray_end);
 
-        // Traces ray against all AABBs in the world
+        // Traces ray against the AABBs in the world
         vector<RayHit> hits;
         {
-            const auto& entities = m_context->GetSubsystem<World>()->EntityGetAll();
-            for (const auto& entity : entities)
+            m_context->GetSubsystem<World>()->BvhRead([this, &hits](const BoundingVolumeHierarchy& bvh)
             {
-                // Make sure there entity has a renderable
-                if (!entity->HasComponent<Renderable>())
-                    continue;
-
-                // Get object oriented bounding box
-                const BoundingBox& aabb = entity->GetComponent<Renderable>()->GetAabb();
-
-                // Compute hit distance
-                float distance = m_ray.HitDistance(aabb);
-
-                // Don't store hit data if there was no hit
-                if (distance == Helper::INFINITY_)
-                    continue;
-
-                hits.emplace_back(
-                    entity,                                             // Entity
-                    m_ray.GetStart() + distance * m_ray.GetDirection(), // Position
-                    distance,                                           // Distance
-                    distance == 0.0f                                    // Inside
-                );
-            }
+                bvh.Query(m_ray, [this, &hits](void* user_data, const float distance)
+                {
+                    Entity* entity = static_cast<Entity*>(user_data);
+
+                    hits.emplace_back(
+                        entity->GetPtrShared(),                             // Entity
+                        m_ray.GetStart() + distance * m_ray.GetDirection(), // Position
+                        distance,                                           // Distance
+                        distance == 0.0f                                    // Inside
+                    );
+                });
+            });
 
             // Sort by distance (ascending)
             std::sort(hits.begin(), hits.end(), [](const RayHit& a, const RayHit& b) { return a.m_distance < b.m_distance; });
@@ -232,37 +223,34 @@ namespace Spartan
         float distance_min = numeric_limits<float>::max();
         for (RayHit& hit : hits)
         {
-            // Get entity geometry
-            Renderable* renderable = hit.m_entity->GetRenderable();
-            vector<uint32_t> indicies;
-            vector<RHI_Vertex_PosTexNorTan> vertices;
-            renderable->GeometryGet(&indicies, &vertices);
-            if (indicies.empty()|| vertices.empty())
+            // Hits are sorted and the box is hit before anything inside it, so no closer triangle can follow
+            if (hit.m_distance > distance_min)
+                break;
+
+            // Get the entity's triangle BVH (built once per mesh)
+            const TriangleBvh* bvh = hit.m_entity->GetRenderable()->GeometryBvh();
+            if (!bvh || !bvh->IsBuilt())
             {
-                LOG_ERROR("Failed to get geometry of entity %s, skipping intersection test.");
+                LOG_ERROR("Failed to get geometry of entity %s, skipping intersection test.", hit.m_entity->GetName().c_str());
                 continue;
             }
 
-            // Compute matrix which can transform vertices to view space
-            Matrix vertex_transform = hit.m_entity->GetTransform()->GetMatrix();
-
-            // Go through each face
-            for (uint32_t i = 0; i < indicies.size(); i += 3)
-            {
-                Vector3 p1_world = Vector3(vertices[indicies[i]].pos) * vertex_transform;
-                Vector3 p2_world = Vector3(vertices[indicies[i + 1]].pos) * vertex_transform;
-                Vector3 p3_world = Vector3(vertices[indicies[i + 2]].pos) * vertex_transform;
+            // Trace in the mesh's space, so that the vertices don't have to be transformed
+            const Matrix& transform = hit.m_entity->GetTransform()->GetMatrix();
+            const Matrix transform_inverse = transform.Inverted();
+            const Ray ray_local = Ray(m_ray.GetStart() * transform_inverse, m_ray.GetEnd() * transform_inverse);
 
-                float distance = m_ray.HitDistance(p1_world, p2_world, p3_world);
-                
-                if (distance < distance_min)
-                {
-                    // Draw min distance triangle
-                    //m_renderer->DrawDebugTriangle(p1_world, p2_world, p3_world, Vector4(1.0f, 0.0f, 0.0f, 1.0f), 5.0f, false);
+            const float distance_local = bvh->HitDistance(ray_local);
+            if (distance_local == Helper::INFINITY_)
+                continue;
 
-                    picked = hit.m_entity;
-                    distance_min = distance;
-                }
+            // The transform may scale, so measure the distance in world space
+            const Vector3 position_world    = (ray_local.GetStart() + ray_local.GetDirection() * distance_local) * transform;
+            const float distance            = (position_world - m_ray.GetStart()).Length();
+            if (distance < distance_min)
+            {
+                picked = hit.m_entity;
+                distance_min = distance;
             }
         }
 
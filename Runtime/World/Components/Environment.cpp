@@ -23,7 +23,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Environment.h"
 #include "../../IO/FileStream.h"
-#include "../../Threading/Threading.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Rendering/Renderer.h"
 #include "../../RHI/RHI_Texture2D.h"
@@ -63,15 +62,26 @@ namespace Spartan
 
     void Environment::OnTick(float delta_time)
     {
-        if (!m_is_dirty)
-            return;
+        if (m_is_dirty)
+        {
+            LoadTexture();
+            m_is_dirty = false;
+        }
 
-        m_context->GetSubsystem<Threading>()->AddTask([this]
+        // The texture is applied once it has loaded
+        if (m_texture_request.IsReady())
         {
-            SetFromTextureSphere(m_file_paths.front());
-        });
+            if (shared_ptr<RHI_Texture> texture = m_texture_request.Get())
+            {
+                SetTexture(texture);
+            }
+            else
+            {
+                LOG_ERROR("Failed to create the environment texture");
+            }
 
-        m_is_dirty = false;
+            m_texture_request = ResourceRequest<RHI_Texture>();
+        }
     }
 
     void Environment::Serialize(FileStream* stream)
@@ -85,19 +95,7 @@ namespace Spartan
         m_environment_type = static_cast<Environment_Type>(stream->ReadAs<uint8_t>());
         stream->Read(&m_file_paths);
 
-        m_context->GetSubsystem<Threading>()->AddTask([this]
-        {
-            if (m_environment_type == Enviroment_Cubemap)
-            {
-                SetFromTextureArray(m_file_paths);
-                
-            }
-            else if (m_environment_type == Environment_Sphere)
-            {
-                
-                SetFromTextureSphere(m_file_paths.front());
-            }
-        });
+        LoadTexture();
     }
 
     void Environment::LoadDefault()
@@ -118,11 +116,32 @@ namespace Spartan
         m_file_paths = { texture ? texture->GetResourceFilePath() : "" };
     }
 
-    void Environment::SetFromTextureArray(const vector<string>& file_paths)
+    void Environment::LoadTexture()
     {
-        if (file_paths.empty())
+        if (m_file_paths.empty() || m_file_paths.front().empty())
             return;
 
+        // The sky is visible right away, so it goes ahead of other loads. The loaders don't capture the component
+        // as it can be removed before they run (a load which is still pending when the world unloads is cancelled).
+        Context* context                = m_context;
+        ResourceCache* resource_cache   = m_context->GetSubsystem<ResourceCache>();
+        if (m_environment_type == Enviroment_Cubemap)
+        {
+            const vector<string> file_paths = m_file_paths;
+            m_texture_request = resource_cache->LoadAsync<RHI_Texture>(Resource_Priority_High, [context, file_paths]() { return CreateFromTextureArray(context, file_paths); });
+        }
+        else if (m_environment_type == Environment_Sphere)
+        {
+            const string file_path = m_file_paths.front();
+            m_texture_request = resource_cache->LoadAsync<RHI_Texture>(Resource_Priority_High, [context, file_path]() { return CreateFromTextureSphere(context, file_path); });
+        }
+    }
+
+    shared_ptr<RHI_Texture> Environment::CreateFromTextureArray(Context* context, const vector<string>& file_paths)
+    {
+        if (file_paths.size() < 6)
+            return nullptr;
+
         LOG_INFO("Creating sky box...");
 
         // Load all textures (sides)
@@ -130,7 +149,7 @@ namespace Spartan
 
         // Load all the cubemap sides
         auto m_generate_mipmaps = false;
-        auto loaderTex = make_shared<RHI_Texture2D>(GetContext(), m_generate_mipmaps);
+        auto loaderTex = make_shared<RHI_Texture2D>(context, m_generate_mipmaps);
         {
             loaderTex->LoadFromFile(file_paths[0]);
             cubemapData.emplace_back(loaderTex->GetMips());
@@ -152,19 +171,18 @@ namespace Spartan
         }
 
         // Texture
-        auto texture = make_shared<RHI_TextureCube>(GetContext(), loaderTex->GetWidth(), loaderTex->GetHeight(), loaderTex->GetFormat(), cubemapData);
-        texture->SetResourceFilePath(m_context->GetSubsystem<ResourceCache>()->GetProjectDirectory() + "environment" + EXTENSION_TEXTURE);
+        auto texture = make_shared<RHI_TextureCube>(context, loaderTex->GetWidth(), loaderTex->GetHeight(), loaderTex->GetFormat(), cubemapData);
+        texture->SetResourceFilePath(context->GetSubsystem<ResourceCache>()->GetProjectDirectory() + "environment" + EXTENSION_TEXTURE);
         texture->SetWidth(loaderTex->GetWidth());
         texture->SetHeight(loaderTex->GetHeight());
         texture->SetGrayscale(false);
 
-        // Apply sky sphere to renderer
-        SetTexture(static_pointer_cast<RHI_Texture>(texture));
-
         LOG_INFO("Sky box has been created successfully");
+
+        return static_pointer_cast<RHI_Texture>(texture);
     }
 
-    void Environment::SetFromTextureSphere(const string& file_path)
+    shared_ptr<RHI_Texture> Environment::CreateFromTextureSphere(Context* context, const string& file_path)
     {
         LOG_INFO("Creating sky sphere...");
 
@@ -172,16 +190,14 @@ namespace Spartan
         auto generate_mipmaps = true;
 
         // Skysphere
-        auto texture = make_shared<RHI_Texture2D>(GetContext(), generate_mipmaps);
-        if (texture->LoadFromFile(file_path))
-        {
-            // Set sky sphere to renderer
-            SetTexture(static_pointer_cast<RHI_Texture>(texture));
-            LOG_INFO("Sky sphere has been created successfully");
-        }
-        else
+        auto texture = make_shared<RHI_Texture2D>(context, generate_mipmaps);
+        if (!texture->LoadFromFile(file_path))
         {
             LOG_ERROR("Sky sphere creation failed");
+            return nullptr;
         }
+
+        LOG_INFO("Sky sphere has been created successfully");
+        return static_pointer_cast<RHI_Texture>(texture);
     }
 }
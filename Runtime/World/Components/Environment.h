@@ -21,10 +21,11 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 #pragma once
 
-//= INCLUDES ========================
+//= INCLUDES ============================
 #include "IComponent.h"
 #include "../../RHI/RHI_Definition.h"
-//===================================
+#include "../../Resource/ResourceRequest.h"
+//=======================================
 
 namespace Spartan
 {
@@ -52,11 +53,13 @@ namespace Spartan
         void SetTexture(const std::shared_ptr<RHI_Texture>& texture);
 
     private:
-        void SetFromTextureArray(const std::vector<std::string>& texturePaths);
-        void SetFromTextureSphere(const std::string& texturePath);
+        void LoadTexture();
+        static std::shared_ptr<RHI_Texture> CreateFromTextureArray(Context* context, const std::vector<std::string>& file_paths);
+        static std::shared_ptr<RHI_Texture> CreateFromTextureSphere(Context* context, const std::string& file_path);
 
         std::vector<std::string> m_file_paths;
         Environment_Type m_environment_type;
         bool m_is_dirty = false;
+        ResourceRequest<RHI_Texture> m_texture_request;
     };
 }
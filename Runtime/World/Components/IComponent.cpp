@@ -66,21 +66,37 @@ namespace Spartan
     template<typename T>
     inline constexpr void validate_component_type() { static_assert(std::is_base_of<IComponent, T>::value, "Provided type does not implement IComponent"); }
 
+    // Which component types do work in OnTick(), filled in by REGISTER_COMPONENT
+    static bool g_component_ticks[component_type_count] = {};
+
+    static bool register_ticks(const ComponentType type, const bool ticks)
+    {
+        g_component_ticks[static_cast<uint32_t>(type)] = ticks;
+        return ticks;
+    }
+
+    bool IComponent::TypeTicks(const ComponentType type)
+    {
+        return type < ComponentType::Unknown ? g_component_ticks[static_cast<uint32_t>(type)] : false;
+    }
+
     // Explicit template instantiation
-    #define REGISTER_COMPONENT(T, enumT) template<> SPARTAN_CLASS ComponentType IComponent::TypeToEnum<T>() { validate_component_type<T>(); return enumT; }
+    #define REGISTER_COMPONENT(T, enumT, ticks)                                                                                 \
+    template<> SPARTAN_CLASS ComponentType IComponent::TypeToEnum<T>() { validate_component_type<T>(); return enumT; }      \
+    static const bool g_component_ticks_##T = register_ticks(enumT, ticks);
 
-    // To add a new component to the engine, simply register it here
-    REGISTER_COMPONENT(AudioListener,    ComponentType::AudioListener)
-    REGISTER_COMPONENT(AudioSource,        ComponentType::AudioSource)
-    REGISTER_COMPONENT(Camera,            ComponentType::Camera)
-    REGISTER_COMPONENT(Collider,        ComponentType::Collider)
-    REGISTER_COMPONENT(Constraint,        ComponentType::Constraint)
-    REGISTER_COMPONENT(Light,            ComponentType::Light)
-    REGISTER_COMPONENT(Renderable,        ComponentType::Renderable)
-    REGISTER_COMPONENT(RigidBody,        ComponentType::RigidBody)
-    REGISTER_COMPONENT(SoftBody,        ComponentType::SoftBody)
-    REGISTER_COMPONENT(Script,            ComponentType::Script)
-    REGISTER_COMPONENT(Environment,        ComponentType::Environment)
-    REGISTER_COMPONENT(Terrain,         ComponentType::Terrain)
-    REGISTER_COMPONENT(Transform,        ComponentType::Transform)
+    // To add a new component to the engine, simply register it here (and state if it needs OnTick() to be called)
+    REGISTER_COMPONENT(AudioListener,   ComponentType::AudioListener,   true)
+    REGISTER_COMPONENT(AudioSource,     ComponentType::AudioSource,     true)
+    REGISTER_COMPONENT(Camera,          ComponentType::Camera,          true)
+    REGISTER_COMPONENT(Collider,        ComponentType::Collider,        false)
+    REGISTER_COMPONENT(Constraint,      ComponentType::Constraint,      true)
+    REGISTER_COMPONENT(Light,           ComponentType::Light,           true)
+    REGISTER_COMPONENT(Renderable,      ComponentType::Renderable,      false)
+    REGISTER_COMPONENT(RigidBody,       ComponentType::RigidBody,       true)
+    REGISTER_COMPONENT(SoftBody,        ComponentType::SoftBody,        true)
+    REGISTER_COMPONENT(Script,          ComponentType::Script,          true)
+    REGISTER_COMPONENT(Environment,     ComponentType::Environment,     true)
+    REGISTER_COMPONENT(Terrain,         ComponentType::Terrain,         false)
+    REGISTER_COMPONENT(Transform,       ComponentType::Transform,       false)
 }
@@ -55,6 +55,8 @@ namespace Spartan
         Unknown
     };
 
+    constexpr uint32_t component_type_count = static_cast<uint32_t>(ComponentType::Unknown);
+
     struct Attribute
     {
         std::function<std::any()> getter;
@@ -91,6 +93,8 @@ namespace Spartan
         //= TYPE ===================================
         template <typename T>
         static constexpr ComponentType TypeToEnum();
+        // Returns true if components of this type do work in OnTick(), as stated when the type was registered
+        static bool TypeTicks(ComponentType type);
         //==========================================
 
         //= PROPERTIES ==========================================================================
@@ -114,6 +118,10 @@ namespace Spartan
         // Entity
         Entity* GetEntity()    const { return m_entity; }
         std::string GetEntityName() const;
+
+        // Position in the World's list of components of this type (maintained by the World)
+        uint32_t GetWorldIndex()    const { return m_world_index; }
+        void SetWorldIndex(uint32_t index) { m_world_index = index; }
         //=======================================================================================
 
     protected:
@@ -150,5 +158,7 @@ namespace Spartan
     private:
         // The attributes of the component
         std::vector<Attribute> m_attributes;
+        // Not in a World list
+        uint32_t m_world_index = 0xFFFFFFFF;
     };
 }
@@ -25,7 +25,6 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Transform.h"
 #include "Camera.h"
 #include "Renderable.h"
-#include "../World.h"
 #include "../../IO/FileStream.h"
 #include "../../Rendering/Renderer.h"
 #include "../../RHI/RHI_Texture2D.h"
@@ -172,9 +171,6 @@ namespace Spartan
         {
             CreateShadowMap();
         }
-
-        
-        m_context->GetSubsystem<World>()->MakeDirty();
     }
 
     void Light::SetColor(const float temperature)
@@ -497,6 +493,11 @@ namespace Spartan
         const auto center       = box.GetCenter();
         const auto extents      = box.GetExtents();
 
+        return IsInViewFrustrum(center, extents, index);
+    }
+
+    bool Light::IsInViewFrustrum(const Vector3& center, const Vector3& extents, uint32_t index) const
+    {
         // ensure that potential shadow casters from behind the near plane are not rejected
         const bool ignore_near_plane = (m_light_type == LightType::Directional) ? true : false;
 
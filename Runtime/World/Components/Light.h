@@ -122,6 +122,10 @@ namespace Spartan
         void CreateShadowMap();
 
         bool IsInViewFrustrum(Renderable* renderable, uint32_t index) const;
+        bool IsInViewFrustrum(const Math::Vector3& center, const Math::Vector3& extents, uint32_t index) const;
+        const Math::Frustum& GetFrustum(uint32_t index) const { return m_shadow_map.slices[index].frustum; }
+        // Directional lights keep casters which are behind the near plane (they can still cast shadows into the view)
+        bool GetFrustumIgnoresNearPlane() const { return m_light_type == LightType::Directional; }
 
     private:
         void ComputeViewMatrix();
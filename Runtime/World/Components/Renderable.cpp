@@ -23,11 +23,13 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "Spartan.h"
 #include "Renderable.h"
 #include "Transform.h"
+#include "../World.h"
 #include "../../IO/FileStream.h"
 #include "../../Resource/ResourceCache.h"
 #include "../../Utilities/Geometry.h"
 #include "../../RHI/RHI_Texture2D.h"
 #include "../../Rendering/Model.h"
+#include "../../Rendering/Renderer.h"
 #include "../../RHI/RHI_Vertex.h"
 //=======================================
 
@@ -164,6 +166,7 @@ namespace Spartan
             string material_name;
             stream->Read(&material_name);
             m_material = m_context->GetSubsystem<ResourceCache>()->GetByName<Material>(material_name);
+            m_context->GetSubsystem<Renderer>()->RenderablesChanged(this);
         }
     }
 
@@ -176,6 +179,10 @@ namespace Spartan
         m_geometryVertexCount   = vertex_count;
         m_bounding_box          = bounding_box;
         m_model                 = model ? model->GetSharedPtr() : nullptr;
+
+        // The world space box has to be recomputed, and the world has to follow it
+        m_aabb = BoundingBox();
+        m_context->GetSubsystem<World>()->RenderableBoundsChanged(GetEntity());
     }
 
     void Renderable::GeometrySet(const Geometry_Type type)
@@ -204,6 +211,17 @@ namespace Spartan
         m_model->GetGeometry(m_geometryIndexOffset, m_geometryIndexCount, m_geometryVertexOffset, m_geometryVertexCount, indices, vertices);
     }
 
+    const TriangleBvh* Renderable::GeometryBvh() const
+    {
+        if (!m_model)
+        {
+            LOG_ERROR("Invalid model");
+            return nullptr;
+        }
+
+        return m_model->GetTriangleBvh(m_geometryIndexOffset, m_geometryIndexCount, m_geometryVertexOffset, m_geometryVertexCount);
+    }
+
     const BoundingBox& Renderable::GetAabb()
     {
         // Updated if dirty
@@ -230,6 +248,9 @@ namespace Spartan
 
         // Set to false otherwise material won't serialize/deserialize
         m_material_default = false;
+
+        // The material decides if the entity is rendered as opaque or transparent
+        m_context->GetSubsystem<Renderer>()->RenderablesChanged(this);
     }
 
     shared_ptr<Material> Renderable::SetMaterial(const string& file_path)
@@ -37,6 +37,7 @@ namespace Spartan
     namespace Math
     {
         class Vector3;
+        class TriangleBvh;
     }
 
     enum Geometry_Type
@@ -73,6 +74,7 @@ namespace Spartan
         void GeometryClear();
         void GeometrySet(Geometry_Type type);
         void GeometryGet(std::vector<uint32_t>* indices, std::vector<RHI_Vertex_PosTexNorTan>* vertices) const;
+        const Math::TriangleBvh* GeometryBvh() const;
         uint32_t GeometryIndexOffset()              const { return m_geometryIndexOffset; }
         uint32_t GeometryIndexCount()               const { return m_geometryIndexCount; }
         uint32_t GeometryVertexOffset()             const { return m_geometryVertexOffset; }
@@ -79,7 +79,7 @@ namespace Spartan
 
     void Terrain::GenerateAsync()
     {
-        if (m_is_generating)
+        if (!m_generation.IsDone())
         {
             LOG_WARNING("Terrain is already being generated, please wait...");
             return;
@@ -101,8 +101,6 @@ namespace Spartan
 
         m_context->GetSubsystem<Threading>()->AddTask([this]()
         {
-            m_is_generating = true;
-
             // Get height map data
             const vector<std::byte> height_map_data = m_height_map->GetOrLoadMip(0);
             if (height_map_data.empty())
@@ -148,9 +146,7 @@ namespace Spartan
             m_progress_jobs_done = 0;
             m_progress_job_count = 1;
             m_progress_desc.clear();
-
-            m_is_generating = false;
-        });
+        }, &m_generation);
     }
 
     bool Terrain::GeneratePositions(vector<Vector3>& positions, const vector<std::byte>& height_map)
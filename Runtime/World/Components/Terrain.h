@@ -25,6 +25,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "IComponent.h"
 #include <atomic>
 #include "../../RHI/RHI_Definition.h"
+#include "../../Threading/Task.h"
 //===================================
 
 namespace Spartan
@@ -73,7 +74,7 @@ namespace Spartan
         float m_min_y                               = 0.0f;
         float m_max_y                               = 30.0f;
         float m_vertex_density                      = 1.0f;
-        bool m_is_generating                        = false;
+        TaskCounter m_generation;
         uint64_t m_vertex_count                     = 0;
         uint64_t m_face_count                       = 0;
         std::atomic<uint64_t> m_progress_jobs_done  = 0;
@@ -83,31 +83,43 @@ namespace Spartan
             }
         }
 
-        UpdateTransform();
+        // The parent might not be deserialized yet, the world computes the matrices once the hierarchy is complete
+        MarkDirty();
     }
 
     void Transform::UpdateTransform()
     {
-        // Compute local transform
-        m_matrixLocal = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
+        MarkDirty();
+        ComputeMatrix();
+    }
 
-        // Compute world transform
-        if (!HasParent())
-        {
-            m_matrix = m_matrixLocal;
-        }
-        else
-        {
-            m_matrix = m_matrixLocal * GetParentTransformMatrix();
-        }
-        
-        // Update children
-        for (const auto& child : m_children)
+    void Transform::MarkDirty()
+    {
+        m_moved = true;
+
+        // A dirty transform always has dirty descendants, so there is nothing more to do
+        if (m_is_dirty)
+            return;
+
+        m_is_dirty = true;
+
+        for (Transform* child : m_children)
         {
-            child->UpdateTransform();
+            child->MarkDirty();
         }
     }
 
+    void Transform::ComputeMatrix()
+    {
+        // Compute local transform
+        m_matrixLocal = Matrix(m_positionLocal, m_rotationLocal, m_scaleLocal);
+
+        // Compute world transform (the parent's is the one it last computed)
+        m_matrix = !HasParent() ? m_matrixLocal : m_matrixLocal * GetParentTransformMatrix();
+
+        m_is_dirty = false;
+    }
+
     void Transform::SetPosition(const Vector3& position)
     {
         if (GetPosition() == position)
@@ -246,11 +258,14 @@ namespace Spartan
         // if the new parent is a descendant of this transform
         if (new_parent->IsDescendantOf(this))
         {
+            // iterate a copy, since the children remove themselves from this transform
+            const vector<Transform*> children = m_children;
+
             // if this transform already has a parent
             if (this->HasParent())
             {
                 // assign the parent of this transform to the children
-                for (const auto& child : m_children)
+                for (const auto& child : children)
                 {
                     child->SetParent(GetParent());
                 }
@@ -258,24 +273,22 @@ namespace Spartan
             else // if this transform doesn't have a parent
             {
                 // make the children orphans
-                for (const auto& child : m_children)
+                for (const auto& child : children)
                 {
                     child->BecomeOrphan();
                 }
             }
         }
 
-        // Switch parent but keep a pointer to the old one
-        auto parent_old = m_parent;
-        m_parent = new_parent;
-        if (parent_old) parent_old->AcquireChildren(); // update the old parent (so it removes this child)
-
-        // make the new parent "aware" of this transform/child
+        // Switch parent, the old one forgets about this child and the new one learns about it
         if (m_parent)
         {
-            m_parent->AcquireChildren();
+            m_parent->ChildRemove(this);
         }
+        m_parent = new_parent;
+        m_parent->ChildAdd(this);
 
+        GetContext()->GetSubsystem<World>()->TransformHierarchyChanged();
         UpdateTransform();
     }
 
@@ -320,50 +333,32 @@ namespace Spartan
         return nullptr;
     }
 
-    // Searches the entire hierarchy, finds any children and saves them in m_children.
-    // This is a recursive function, the children will also find their own children and so on...
-    void Transform::AcquireChildren()
+    void Transform::ChildAdd(Transform* child)
     {
-        m_children.clear();
-        m_children.shrink_to_fit();
+        // Only called when the child's parent becomes this transform, so it can't already be here
+        m_children.emplace_back(child);
+    }
 
-        auto entities = GetContext()->GetSubsystem<World>()->EntityGetAll();
-        for (const auto& entity : entities)
+    void Transform::ChildRemove(Transform* child)
+    {
+        // Searched from the back, as children are usually removed in reverse order (or right after being added)
+        for (auto it = m_children.rbegin(); it != m_children.rend(); it++)
         {
-            if (!entity)
-                continue;
-
-            // get the possible child
-            auto possible_child = entity->GetTransform();
-
-            // if it doesn't have a parent, forget about it.
-            if (!possible_child->HasParent())
-                continue;
-
-            // if it's parent matches this transform
-            if (possible_child->GetParent()->GetId() == GetId())
+            if (*it == child)
             {
-                // welcome home son
-                m_children.emplace_back(possible_child);
-
-                // make the child do the same thing all over, essentially resolving the entire hierarchy.
-                possible_child->AcquireChildren();
+                m_children.erase(next(it).base());
+                return;
             }
         }
     }
 
     bool Transform::IsDescendantOf(const Transform* transform) const
     {
-        for (const Transform* child : transform->GetChildren())
+        // Walk up the ancestors, which is a lot shorter than walking down the descendants
+        for (const Transform* ancestor = m_parent; ancestor; ancestor = ancestor->GetParent())
         {
-            if (GetId() == child->GetId())
+            if (ancestor->GetId() == transform->GetId())
                 return true;
-
-            if (child->HasChildren())
-            {
-                if (IsDescendantOf(child))
-                    return true;
-            }
         }
 
         return false;
@@ -401,14 +396,10 @@ namespace Spartan
         m_parent = nullptr;
 
         // Update the transform without the parent now
+        GetContext()->GetSubsystem<World>()->TransformHierarchyChanged();
         UpdateTransform();
 
-        // make the parent search for children,
-        // that's indirect way of making the parent "forget"
-        // about this child, since it won't be able to find it
-        if (temp_ref)
-        {
-            temp_ref->AcquireChildren();
-        }
+        // make the parent forget about this child
+        temp_ref->ChildRemove(this);
     }
 }
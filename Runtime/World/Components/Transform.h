@@ -46,24 +46,30 @@ namespace Spartan
         void Deserialize(FileStream* stream) override;
         //============================================
 
+        // Computes the matrices of this transform now (from the parent's current ones), its descendants follow when the world next updates them
         void UpdateTransform();
+        bool IsDirty() const { return m_is_dirty; }
+
+        // Set whenever the transform changes, the world clears it once it has followed the change (e.g. in the BVH)
+        bool HasMoved() const   { return m_moved; }
+        void ClearMoved()       { m_moved = false; }
 
         //= POSITION ==============================================================
-        Math::Vector3 GetPosition()     const { return m_matrix.GetTranslation(); }
+        Math::Vector3 GetPosition()     const { return GetMatrix().GetTranslation(); }
         const auto& GetPositionLocal()  const { return m_positionLocal; }
         void SetPosition(const Math::Vector3& position);
         void SetPositionLocal(const Math::Vector3& position);
         //=========================================================================
 
         //= ROTATION ===========================================================
-        Math::Quaternion GetRotation() const { return m_matrix.GetRotation(); }
+        Math::Quaternion GetRotation() const { return GetMatrix().GetRotation(); }
         const auto& GetRotationLocal() const { return m_rotationLocal; }
         void SetRotation(const Math::Quaternion& rotation);
         void SetRotationLocal(const Math::Quaternion& rotation);
         //======================================================================
 
         //= SCALE =======================================================
-        auto GetScale()             const { return m_matrix.GetScale(); }
+        auto GetScale()             const { return GetMatrix().GetScale(); }
         const auto& GetScaleLocal() const { return m_scaleLocal; }
         void SetScale(const Math::Vector3& scale);
         void SetScaleLocal(const Math::Vector3& scale);
@@ -96,32 +102,40 @@ namespace Spartan
         Transform* GetChildByIndex(uint32_t index);
         Transform* GetChildByName(const std::string& name);
         const std::vector<Transform*>& GetChildren() const    { return m_children; }
-    
-        void AcquireChildren();
+
         bool IsDescendantOf(const Transform* transform) const;
         void GetDescendants(std::vector<Transform*>* descendants);
         //======================================================================================
 
         void LookAt(const Math::Vector3& v)                       { m_lookAt = v; }
-        const Math::Matrix& GetMatrix()                     const { return m_matrix; }     
+        // The last computed matrices, reading never computes (so it's safe from any thread). A transform computes its own
+        // when it's changed, and the world computes all those which are dirty (e.g. descendants) once per frame.
+        const Math::Matrix& GetMatrix()                     const { return m_matrix; }
         const Math::Matrix& GetLocalMatrix()                const { return m_matrixLocal; }
         const Math::Matrix& GetWvpLastFrame()               const { return m_wvp_previous; }
         void SetWvpLastFrame(const Math::Matrix& matrix)          { m_wvp_previous = matrix;}
 
     private:
         Math::Matrix GetParentTransformMatrix() const;
+        void MarkDirty();
+        void ChildAdd(Transform* child);
+        void ChildRemove(Transform* child);
+        void ComputeMatrix();
 
         // local
         Math::Vector3 m_positionLocal;
         Math::Quaternion m_rotationLocal;
         Math::Vector3 m_scaleLocal;
 
+        // Computed when changed, or by the world once per frame (parents before children)
         Math::Matrix m_matrix;
         Math::Matrix m_matrixLocal;
+        bool m_is_dirty         = true;
+        bool m_moved            = true;
         Math::Vector3 m_lookAt;
 
         Transform* m_parent; // the parent of this transform
-        std::vector<Transform*> m_children; // the children of this transform
+        std::vector<Transform*> m_children; // the children of this transform, kept up to date by SetParent() and BecomeOrphan()
 
         Math::Matrix m_wvp_previous;
     };
@@ -72,6 +72,40 @@ namespace Spartan
         m_components.clear();
     }
 
+    void Entity::SetName(const string& name)
+    {
+        m_name = name;
+
+        if (m_handle.IsValid())
+        {
+            m_context->GetSubsystem<World>()->EntityNameChanged();
+        }
+    }
+
+    void Entity::SetId(const uint32_t id)
+    {
+        const uint32_t id_old = m_id;
+        m_id = id;
+
+        if (m_handle.IsValid() && id != id_old)
+        {
+            m_context->GetSubsystem<World>()->EntityIdChanged(this, id_old);
+        }
+    }
+
+    void Entity::SetActive(const bool active)
+    {
+        if (active == m_is_active)
+            return;
+
+        m_is_active = active;
+
+        if (m_handle.IsValid())
+        {
+            m_context->GetSubsystem<World>()->EntityActiveChanged(this);
+        }
+    }
+
     void Entity::Clone()
     {
         auto scene = m_context->GetSubsystem<World>();
@@ -144,10 +178,13 @@ namespace Spartan
         if (!m_is_active)
             return;
 
-        // call component Update()
+        // call component Update(), on the types which need it
         for (const auto& component : m_components)
         {
-            component->OnTick(delta_time);
+            if (IComponent::TypeTicks(component->GetType()))
+            {
+                component->OnTick(delta_time);
+            }
         }
     }
 
@@ -209,10 +246,10 @@ namespace Spartan
     {
         // BASIC DATA
         {
-            stream->Read(&m_is_active);
+            SetActive(stream->ReadAs<bool>());
             stream->Read(&m_hierarchy_visibility);
-            stream->Read(&m_id);
-            stream->Read(&m_name);
+            SetId(stream->ReadAs<uint32_t>());
+            SetName(stream->ReadAs<string>());
         }
 
         // COMPONENTS
@@ -264,15 +301,7 @@ namespace Spartan
             {
                 child.lock()->Deserialize(stream, GetTransform());
             }
-
-            if (m_transform)
-            {
-                m_transform->AcquireChildren();
-            }
         }
-
-        // Make the scene resolve
-        FIRE_EVENT(EventType::WorldResolve);
     }
 
     IComponent* Entity::AddComponent(const ComponentType type, uint32_t id /*= 0*/)
@@ -304,16 +333,14 @@ namespace Spartan
 
     void Entity::RemoveComponentById(const uint32_t id)
     {
-        ComponentType component_type = ComponentType::Unknown;
-
         for (auto it = m_components.begin(); it != m_components.end(); ) 
         {
             auto component = *it;
             if (id == component->GetId())
             {
-                component_type = component->GetType();
                 component->OnRemove();
-                it = m_components.erase(it);    
+                it = m_components.erase(it);
+                ComponentRemoved(component.get());
                 break;
             }
             else
@@ -321,21 +348,60 @@ namespace Spartan
                 ++it;
             }
         }
+    }
 
-        // The script component can have multiple instance, so only remove
-        // it's flag if there are no more components of that type left
-        bool others_of_same_type_exist = false;
-        for (auto it = m_components.begin(); it != m_components.end(); ++it)
+    void Entity::ComponentAdded(IComponent* component)
+    {
+        const ComponentType type = component->GetType();
+
+        if (!m_components_by_type[static_cast<uint32_t>(type)])
         {
-            others_of_same_type_exist = ((*it)->GetType() == component_type) ? true : others_of_same_type_exist;
+            m_components_by_type[static_cast<uint32_t>(type)] = component;
         }
+        m_component_mask |= GetComponentMask(type);
+
+        // Caching of rendering performance critical components
+        if (type == ComponentType::Transform)   { m_transform   = static_cast<Transform*>(component); }
+        if (type == ComponentType::Renderable)  { m_renderable  = static_cast<Renderable*>(component); }
 
-        if (!others_of_same_type_exist)
+        if (m_handle.IsValid())
         {
-            m_component_mask &= ~GetComponentMask(component_type);
+            m_context->GetSubsystem<World>()->ComponentRegister(component);
         }
+    }
 
-        // Make the scene resolve
-        FIRE_EVENT(EventType::WorldResolve);
+    void Entity::ComponentRemoved(IComponent* component)
+    {
+        const ComponentType type = component->GetType();
+
+        if (m_handle.IsValid())
+        {
+            m_context->GetSubsystem<World>()->ComponentUnregister(component);
+        }
+
+        if (m_components_by_type[static_cast<uint32_t>(type)] != component)
+            return;
+
+        // The script component can have multiple instances, so the next one of the same type (if any) takes its place
+        IComponent* next = nullptr;
+        for (const auto& other : m_components)
+        {
+            if (other->GetType() == type)
+            {
+                next = other.get();
+                break;
+            }
+        }
+        m_components_by_type[static_cast<uint32_t>(type)] = next;
+
+        if (!next)
+        {
+            m_component_mask &= ~GetComponentMask(type);
+
+            if (type == ComponentType::Renderable)
+            {
+                m_renderable = nullptr;
+            }
+        }
     }
 }
@@ -23,7 +23,9 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 
 //= INCLUDES =====================
 #include <vector>
+#include <array>
 #include "../Core/EventSystem.h"
+#include "EntityHandle.h"
 #include "Components/IComponent.h"
 //================================
 
@@ -48,10 +50,10 @@ namespace Spartan
 
         //= PROPERTIES ===================================================================================================
         const std::string& GetName() const                                { return m_name; }
-        void SetName(const std::string& name)                            { m_name = name; }
+        void SetName(const std::string& name);
 
         bool IsActive() const                                            { return m_is_active; }
-        void SetActive(const bool active)                                { m_is_active = active; }
+        void SetActive(bool active);
 
         bool IsVisibleInHierarchy() const                                { return m_hierarchy_visibility; }
         void SetHierarchyVisibility(const bool hierarchy_visibility)    { m_hierarchy_visibility = hierarchy_visibility; }
@@ -71,20 +73,13 @@ namespace Spartan
             std::shared_ptr<T> component = std::make_shared<T>(m_context, this, id);
 
             // Save new component
+            component->SetType(type);
             m_components.emplace_back(std::static_pointer_cast<IComponent>(component));
-            m_component_mask |= GetComponentMask(type);
-
-            // Caching of rendering performance critical components
-            if constexpr (std::is_same<T, Transform>::value)    { m_transform   = static_cast<Transform*>(component.get()); }
-            if constexpr (std::is_same<T, Renderable>::value)   { m_renderable  = static_cast<Renderable*>(component.get()); }
+            ComponentAdded(component.get());
 
             // Initialize component
-            component->SetType(type);
             component->OnInitialize();
 
-            // Make the scene resolve
-            FIRE_EVENT(EventType::WorldResolve);
-
             return component.get();
         }
 
@@ -97,16 +92,7 @@ namespace Spartan
         {
             const ComponentType type = IComponent::TypeToEnum<T>();
 
-            if (!HasComponent(type))
-                return nullptr;
-
-            for (const auto& component : m_components)
-            {
-                if (component->GetType() == type)
-                    return static_cast<T*>(component.get());
-            }
-
-            return nullptr;
+            return static_cast<T*>(m_components_by_type[static_cast<uint32_t>(type)]);
         }
 
         // Returns any components of type T (if they exist)
@@ -150,21 +136,25 @@ namespace Spartan
                 {
                     component->OnRemove();
                     it = m_components.erase(it);
-                    m_component_mask &= ~GetComponentMask(type);
+                    ComponentRemoved(component.get());
                 }
                 else
                 {
                     ++it;
                 }
             }
-
-            // Make the scene resolve
-            FIRE_EVENT(Event_World_Resolve_Pending);
         }
 
         void RemoveComponentById(uint32_t id);
         const auto& GetAllComponents() const { return m_components; }
 
+        // The id can change after creation (e.g. when deserializing), so the World's id index is kept in sync here
+        void SetId(uint32_t id);
+
+        // Assigned by the World when the entity is added to it
+        const EntityHandle& GetHandle() const               { return m_handle; }
+        void SetHandle(const EntityHandle& handle)          { m_handle = handle; }
+
         void MarkForDestruction()           { m_destruction_pending = true; }
         bool IsPendingDestruction() const   { return m_destruction_pending; }
 
@@ -175,6 +165,9 @@ namespace Spartan
 
     private:
         constexpr uint32_t GetComponentMask(ComponentType type) { return static_cast<uint32_t>(1) << static_cast<uint32_t>(type); }
+        // Keep the type lookup, the cached components and the World's component lists in sync (call after adding/erasing)
+        void ComponentAdded(IComponent* component);
+        void ComponentRemoved(IComponent* component);
 
         std::string m_name            = "Entity";
         bool m_is_active            = true;
@@ -182,9 +175,11 @@ namespace Spartan
         Transform* m_transform        = nullptr;
         Renderable* m_renderable    = nullptr;
         bool m_destruction_pending  = false;
+        EntityHandle m_handle;
         
         // Components
         std::vector<std::shared_ptr<IComponent>> m_components;
+        std::array<IComponent*, component_type_count> m_components_by_type = {}; // the first component of each type
         uint32_t m_component_mask = 0;
     };
 }
@@ -0,0 +1,47 @@
+/*
+Copyright(c) 2016-2020 Panos Karabelas
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and / or sell
+copies of the Software, and to permit persons to whom the Software is furnished
+to do so, subject to the following conditions :
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.IN NO EVENT SHALL THE AUTHORS OR
+COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#pragma once
+
+//= INCLUDES =====
+#include <cstdint>
+//================
+
+namespace Spartan
+{
+    // A stable reference to an entity which the World can validate. The slot index is reused once the entity is removed,
+    // but the generation is bumped, so stale handles resolve to nothing instead of to whichever entity took the slot.
+    struct EntityHandle
+    {
+        static constexpr uint32_t index_invalid = 0xFFFFFFFF;
+
+        EntityHandle() = default;
+        EntityHandle(const uint32_t index, const uint32_t generation) : index(index), generation(generation) {}
+
+        bool IsValid() const { return index != index_invalid; }
+
+        bool operator==(const EntityHandle& rhs) const { return index == rhs.index && generation == rhs.generation; }
+        bool operator!=(const EntityHandle& rhs) const { return !(*this == rhs); }
+
+        uint32_t index      = index_invalid;
+        uint32_t generation = 0;
+    };
+}
@@ -24,6 +24,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "World.h"
 #include "Entity.h"
 #include "Components/Transform.h"
+#include "Components/Renderable.h"
 #include "Components/Camera.h"
 #include "Components/Light.h"
 #include "Components/Environment.h"
@@ -35,6 +36,7 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include "../Rendering/Renderer.h"
 #include "../Input/Input.h"
 #include "../RHI/RHI_Device.h"
+#include "../Threading/Threading.h"
 //=====================================
 
 //= NAMESPACES ================
@@ -44,10 +46,104 @@ using namespace Spartan::Math;
 
 namespace Spartan
 {
+    // Depth levels with fewer transforms than this are not worth spreading across threads
+    static constexpr uint32_t transform_parallel_threshold = 512;
+
+    // World files start with a header and a table of sections (strings, entities and one block per component type).
+    // The file version is that of the header and the table, files which are newer than that are refused. Every section
+    // has a version of its own, bumped when its layout changes, and readers skip the sections which are newer than they know.
+    // Readers also ignore sections they don't know and skip the unread tail of every component record.
+    static constexpr uint32_t world_file_magic      = 0x44575053; // "SPWD"
+    static constexpr uint32_t world_file_version    = 2;          // 1 had no section versions
+    static constexpr uint32_t world_section_version = 1;          // the current layout of every section
+
+    enum World_Section : uint32_t
+    {
+        World_Section_Strings,
+        World_Section_Entities,
+        World_Section_Components // + the component type
+    };
+
+    struct WorldSection
+    {
+        uint32_t id         = 0;
+        uint32_t version    = world_section_version;
+        uint64_t offset     = 0;
+        uint64_t size       = 0;
+    };
+
+    // Component types whose Deserialize() has been checked to only touch their own state, thread safe subsystems and already computed
+    // transforms, so they can deserialize in parallel. Anything not listed here (e.g. creating GPU resources or other components) is serial.
+    static bool component_deserializes_in_parallel(const ComponentType type)
+    {
+        return
+            type == ComponentType::AudioSource  || // looks up its clip in the resource cache
+            type == ComponentType::Camera       || // reads its transform
+            type == ComponentType::Environment;    // requests its texture from the resource cache
+    }
+
+    static void gather_hierarchy(Entity* entity, vector<Entity*>& entities)
+    {
+        entities.emplace_back(entity);
+
+        for (Transform* child : entity->GetTransform()->GetChildren())
+        {
+            gather_hierarchy(child->GetEntity(), entities);
+        }
+    }
+
+    static void serialize_components(FileStream* file, const vector<IComponent*>& components)
+    {
+        file->Write(static_cast<uint32_t>(components.size()));
+
+        for (IComponent* component : components)
+        {
+            // Records are prefixed with their size, so that readers can skip data they don't know about
+            const uint64_t size_position = file->GetPosition();
+            file->Write(static_cast<uint64_t>(0));
+            component->Serialize(file);
+
+            const uint64_t end = file->GetPosition();
+            file->Seek(size_position);
+            file->Write(end - size_position - sizeof(uint64_t));
+            file->Seek(end);
+        }
+    }
+
+    static void deserialize_components(FileStream* file, const WorldSection& section, const vector<IComponent*>& components)
+    {
+        file->Seek(section.offset);
+
+        if (file->ReadAs<uint32_t>() != static_cast<uint32_t>(components.size()))
+        {
+            LOG_ERROR("Component block %d doesn't match the entity table, skipping it", section.id - World_Section_Components);
+            return;
+        }
+
+        for (IComponent* component : components)
+        {
+            const uint64_t size     = file->ReadAs<uint64_t>();
+            const uint64_t start    = file->GetPosition();
+            component->Deserialize(file);
+            file->Seek(start + size);
+        }
+    }
+
+    static BoundingBox get_bvh_box(Entity* entity, Renderable* renderable)
+    {
+        // Renderables without geometry have no meaningful bounds (they can even be NaN), so they are treated as a point
+        const BoundingBox& box = renderable->GetAabb();
+        const bool is_valid = box.GetMin().x <= box.GetMax().x && box.GetMin().y <= box.GetMax().y && box.GetMin().z <= box.GetMax().z;
+        if (is_valid)
+            return box;
+
+        const Vector3 position = entity->GetTransform()->GetPosition();
+        return BoundingBox(position, position);
+    }
+
     World::World(Context* context) : ISubsystem(context)
     {
         // Subscribe to events
-        SUBSCRIBE_TO_EVENT(EventType::WorldResolve, [this](Variant) { m_is_dirty = true; });
         SUBSCRIBE_TO_EVENT(EventType::WorldStop,    [this](Variant)    { m_state = WorldState::Idle; });
         SUBSCRIBE_TO_EVENT(EventType::WorldStart,   [this](Variant)    { m_state = WorldState::Ticking; });
     }
@@ -63,6 +159,8 @@ namespace Spartan
     {
         m_input        = m_context->GetSubsystem<Input>();
         m_profiler    = m_context->GetSubsystem<Profiler>();
+        m_threading   = m_context->GetSubsystem<Threading>();
+        m_renderer    = m_context->GetSubsystem<Renderer>();
 
         CreateCamera();
         CreateEnvironment();
@@ -84,6 +182,8 @@ namespace Spartan
 
         SCOPED_TIME_BLOCK(m_profiler);
 
+        lock_guard<recursive_mutex> lock(m_mutex);
+
         // Tick entities
         {
             // Detect game toggling
@@ -109,33 +209,42 @@ namespace Spartan
                 }
             }
 
-            // Tick
-            for (const auto& entity : m_entities)
+            // Tick, a type at a time and only the types which need it (most entities are static and have nothing to do)
+            for (uint32_t type = 0; type < component_type_count; type++)
             {
-                entity->Tick(delta_time);
-            }
-        }
-
-        if (m_is_dirty)
-        {
-            // Update dirty entities
-            {
-                // Make a copy so we can iterate while removing entities
-                auto entities_copy = m_entities;
+                if (!IComponent::TypeTicks(static_cast<ComponentType>(type)))
+                    continue;
 
-                for (const auto& entity : entities_copy)
+                // Indexed, as a tick is free to add components
+                const vector<IComponent*>& components = m_components[type];
+                for (uint32_t i = 0; i < static_cast<uint32_t>(components.size()); i++)
                 {
-                    if (entity->IsPendingDestruction())
+                    IComponent* component = components[i];
+                    if (component->GetEntity()->IsActive())
                     {
-                        _EntityRemove(entity);
+                        component->OnTick(delta_time);
                     }
                 }
             }
+        }
+
+        // Remove the entities which were marked for destruction (swapped out, as removal can mark more)
+        if (!m_entities_pending_destruction.empty())
+        {
+            vector<shared_ptr<Entity>> entities;
+            entities.swap(m_entities_pending_destruction);
 
-            // Notify Renderer
-            FIRE_EVENT_DATA(EventType::WorldResolved, m_entities);
-            m_is_dirty = false;
+            for (const auto& entity : entities)
+            {
+                _EntityRemove(entity);
+            }
         }
+
+        // Propagate whatever moved this frame, once, from the roots down
+        TransformsUpdate();
+
+        // Follow any movement
+        BvhUpdate();
     }
 
     void World::Unload()
@@ -143,10 +252,41 @@ namespace Spartan
         // Notify any systems that the entities are about to be cleared
         FIRE_EVENT(EventType::WorldUnload);
 
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        // The tree goes first, as it refers to the entities
+        {
+            unique_lock<shared_mutex> lock_bvh(m_bvh_mutex);
+            m_bvh.Clear();
+        }
+        m_bvh_proxies.clear();
+
         m_entities.clear();
         m_entities.shrink_to_fit();
-
-        m_is_dirty = true;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(m_entity_slots.size()); i++)
+        {
+            if (m_entity_slots[i].entity)
+            {
+                m_entity_slots[i].entity.reset();
+                m_entity_slots[i].generation++;
+                m_entity_slots_free.emplace_back(i);
+            }
+        }
+        m_entity_index_id.clear();
+        m_entity_index_name.clear();
+        m_entity_index_name_dirty = true;
+        for (vector<IComponent*>& components : m_components)
+        {
+            components.clear();
+        }
+        m_entities_pending_destruction.clear();
+        {
+            lock_guard<mutex> lock(m_bvh_dirty_mutex);
+            m_bvh_dirty.clear();
+        }
+        m_transforms.clear();
+        m_transform_levels.clear();
+        m_transforms_dirty = true;
     }
 
     bool World::SaveToFile(const string& filePathIn)
@@ -176,28 +316,103 @@ namespace Spartan
             return false;
         }
 
-        // Only save root entities as they will also save their descendants
-        auto root_actors = EntityGetRoots();
-        const auto root_entity_count = static_cast<uint32_t>(root_actors.size());
+        // Entities are stored depth first, so that parents always load before their children
+        vector<Entity*> entities;
+        for (const shared_ptr<Entity>& root : EntityGetRoots())
+        {
+            gather_hierarchy(root.get(), entities);
+        }
 
-        ProgressReport::Get().SetJobCount(g_progress_world, root_entity_count);
+        // Names go to a string table (they repeat a lot), components are grouped by type
+        vector<string> strings;
+        unordered_map<string, uint32_t> string_indices;
+        vector<uint32_t> entity_names(entities.size());
+        array<vector<IComponent*>, component_type_count> components;
+        for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+        {
+            const auto it = string_indices.emplace(entities[i]->GetName(), static_cast<uint32_t>(strings.size()));
+            if (it.second)
+            {
+                strings.emplace_back(entities[i]->GetName());
+            }
+            entity_names[i] = it.first->second;
 
-        // Save root entity count
-        file->Write(root_entity_count);
+            for (const shared_ptr<IComponent>& component : entities[i]->GetAllComponents())
+            {
+                components[static_cast<uint32_t>(component->GetType())].emplace_back(component.get());
+            }
+        }
 
-        // Save root entity IDs
-        for (const auto& root : root_actors)
+        vector<WorldSection> sections(2);
+        sections[0].id = World_Section_Strings;
+        sections[1].id = World_Section_Entities;
+        for (uint32_t type = 0; type < component_type_count; type++)
         {
-            file->Write(root->GetId());
+            if (!components[type].empty())
+            {
+                sections.emplace_back().id = World_Section_Components + type;
+            }
         }
 
-        // Save root entities
-        for (const auto& root : root_actors)
+        ProgressReport::Get().SetJobCount(g_progress_world, static_cast<uint32_t>(sections.size()));
+
+        // Header, the section table is written again once the offsets are known
+        file->Write(world_file_magic);
+        file->Write(world_file_version);
+        file->Write(static_cast<uint32_t>(sections.size()));
+        const uint64_t table_position = file->GetPosition();
+        for (const WorldSection& section : sections)
         {
-            root->Serialize(file.get());
+            file->Write(section.id);
+            file->Write(section.version);
+            file->Write(section.offset);
+            file->Write(section.size);
+        }
+
+        for (WorldSection& section : sections)
+        {
+            section.offset = file->GetPosition();
+
+            if (section.id == World_Section_Strings)
+            {
+                file->Write(strings);
+            }
+            else if (section.id == World_Section_Entities)
+            {
+                file->Write(static_cast<uint32_t>(entities.size()));
+                for (uint32_t i = 0; i < static_cast<uint32_t>(entities.size()); i++)
+                {
+                    Entity* entity = entities[i];
+                    file->Write(entity->GetId());
+                    file->Write(entity->IsActive());
+                    file->Write(entity->IsVisibleInHierarchy());
+                    file->Write(entity_names[i]);
+                    file->Write(static_cast<uint32_t>(entity->GetAllComponents().size()));
+                    for (const shared_ptr<IComponent>& component : entity->GetAllComponents())
+                    {
+                        file->Write(static_cast<uint32_t>(component->GetType()));
+                        file->Write(component->GetId());
+                    }
+                }
+            }
+            else
+            {
+                serialize_components(file.get(), components[section.id - World_Section_Components]);
+            }
+
+            section.size = file->GetPosition() - section.offset;
             ProgressReport::Get().IncrementJobsDone(g_progress_world);
         }
 
+        file->Seek(table_position);
+        for (const WorldSection& section : sections)
+        {
+            file->Write(section.id);
+            file->Write(section.version);
+            file->Write(section.offset);
+            file->Write(section.size);
+        }
+
         // Finish with progress report and timer
         ProgressReport::Get().SetIsLoading(g_progress_world, false);
         LOG_INFO("Saving took %.2f ms", timer.GetElapsedTimeMs());
@@ -242,6 +457,181 @@ namespace Spartan
         // Notify subsystems that need to load data
         FIRE_EVENT(EventType::WorldLoad);
 
+        // Files without a header predate the sectioned format
+        if (file->ReadAs<uint32_t>() == world_file_magic)
+        {
+            if (!FileLoad(file.get(), file_path))
+            {
+                LOG_ERROR("Failed to load \"%s\"", file_path.c_str());
+            }
+        }
+        else
+        {
+            file->Seek(0);
+            FileLoadLegacy(file.get());
+        }
+
+        m_state        = WorldState::Ticking;
+        ProgressReport::Get().SetIsLoading(g_progress_world, false);    
+        LOG_INFO("Loading took %.2f ms", timer.GetElapsedTimeMs());
+
+        FIRE_EVENT(EventType::WorldLoaded);
+        return true;
+    }
+
+    bool World::FileLoad(FileStream* file, const string& file_path)
+    {
+        const uint32_t version = file->ReadAs<uint32_t>();
+        if (version > world_file_version)
+        {
+            LOG_ERROR("\"%s\" is version %d, this build can only read up to version %d", file_path.c_str(), version, world_file_version);
+            return false;
+        }
+
+        vector<WorldSection> sections(file->ReadAs<uint32_t>());
+        const WorldSection* section_strings     = nullptr;
+        const WorldSection* section_entities    = nullptr;
+        array<const WorldSection*, component_type_count> section_components = {};
+        for (WorldSection& section : sections)
+        {
+            file->Read(&section.id);
+            section.version = version >= 2 ? file->ReadAs<uint32_t>() : 1;
+            file->Read(&section.offset);
+            file->Read(&section.size);
+
+            // Written with a layout this build doesn't know
+            if (section.version > world_section_version)
+            {
+                LOG_WARNING("Section %d of \"%s\" is version %d, this build can only read up to version %d, skipping it", section.id, file_path.c_str(), section.version, world_section_version);
+                continue;
+            }
+
+            if (section.id == World_Section_Strings)
+            {
+                section_strings = &section;
+            }
+            else if (section.id == World_Section_Entities)
+            {
+                section_entities = &section;
+            }
+            else if (section.id >= World_Section_Components && section.id - World_Section_Components < component_type_count)
+            {
+                section_components[section.id - World_Section_Components] = &section;
+            }
+        }
+
+        if (!section_strings || !section_entities)
+        {
+            LOG_ERROR("The entity table is missing (or can't be read by this build)");
+            return false;
+        }
+
+        ProgressReport::Get().SetJobCount(g_progress_world, static_cast<uint32_t>(sections.size()));
+
+        vector<string> strings;
+        file->Seek(section_strings->offset);
+        file->Read(&strings);
+        ProgressReport::Get().IncrementJobsDone(g_progress_world);
+
+        // Create the entities and their components, the components are deserialized afterwards, per type
+        array<vector<IComponent*>, component_type_count> components;
+        file->Seek(section_entities->offset);
+        const uint32_t entity_count = file->ReadAs<uint32_t>();
+        for (uint32_t i = 0; i < entity_count; i++)
+        {
+            Entity* entity = EntityCreate().get();
+            entity->SetId(file->ReadAs<uint32_t>());
+            entity->SetActive(file->ReadAs<bool>());
+            entity->SetHierarchyVisibility(file->ReadAs<bool>());
+            const uint32_t name = file->ReadAs<uint32_t>();
+            entity->SetName(name < strings.size() ? strings[name] : "Entity");
+
+            const uint32_t component_count = file->ReadAs<uint32_t>();
+            for (uint32_t j = 0; j < component_count; j++)
+            {
+                const uint32_t type = file->ReadAs<uint32_t>();
+                const uint32_t id   = file->ReadAs<uint32_t>();
+
+                // Types which this build doesn't know about are skipped, their block will be ignored too
+                if (type >= component_type_count)
+                    continue;
+
+                if (IComponent* component = entity->AddComponent(static_cast<ComponentType>(type), id))
+                {
+                    components[type].emplace_back(component);
+                }
+            }
+        }
+        ProgressReport::Get().IncrementJobsDone(g_progress_world);
+
+        // Transforms go first, as everything else can depend on them
+        const uint32_t transform = static_cast<uint32_t>(ComponentType::Transform);
+        if (section_components[transform])
+        {
+            deserialize_components(file, *section_components[transform], components[transform]);
+            ProgressReport::Get().IncrementJobsDone(g_progress_world);
+        }
+
+        // Bring every transform up to date now, so that the components that follow only ever read them (instead of several
+        // threads computing the same dirty parents at once)
+        {
+            lock_guard<recursive_mutex> lock(m_mutex);
+            TransformsUpdate();
+        }
+
+        // Self contained blocks load in parallel, each reading through its own stream
+        vector<uint32_t> types_parallel;
+        for (uint32_t type = 0; type < component_type_count; type++)
+        {
+            if (section_components[type] && component_deserializes_in_parallel(static_cast<ComponentType>(type)))
+            {
+                types_parallel.emplace_back(type);
+            }
+        }
+
+        m_context->GetSubsystem<Threading>()->AddTaskLoop([&](uint32_t start, uint32_t end)
+        {
+            for (uint32_t i = start; i < end; i++)
+            {
+                FileStream stream(file_path, FileStream_Read);
+                if (stream.IsOpen())
+                {
+                    deserialize_components(&stream, *section_components[types_parallel[i]], components[types_parallel[i]]);
+                }
+            }
+        }, static_cast<uint32_t>(types_parallel.size()), 1);
+        for (size_t i = 0; i < types_parallel.size(); i++)
+        {
+            ProgressReport::Get().IncrementJobsDone(g_progress_world); // not thread safe, so it's reported here
+        }
+
+        // The rest, in dependency order (a terrain adds a renderable, physics needs the geometry)
+        static const ComponentType types_serial[] =
+        {
+            ComponentType::AudioListener,
+            ComponentType::Light,
+            ComponentType::Renderable,
+            ComponentType::Terrain,
+            ComponentType::RigidBody,
+            ComponentType::Collider,
+            ComponentType::Constraint,
+            ComponentType::SoftBody,
+            ComponentType::Script
+        };
+        for (const ComponentType type : types_serial)
+        {
+            if (const WorldSection* section = section_components[static_cast<uint32_t>(type)])
+            {
+                deserialize_components(file, *section, components[static_cast<uint32_t>(type)]);
+                ProgressReport::Get().IncrementJobsDone(g_progress_world);
+            }
+        }
+
+        return true;
+    }
+
+    void World::FileLoadLegacy(FileStream* file)
+    {
         // Load root entity count
         const auto root_entity_count = file->ReadAs<uint32_t>();
 
@@ -257,24 +647,19 @@ namespace Spartan
         // Serialize root entities
         for (uint32_t i = 0; i < root_entity_count; i++)
         {
-            m_entities[i]->Deserialize(file.get(), nullptr);
+            m_entities[i]->Deserialize(file, nullptr);
             ProgressReport::Get().IncrementJobsDone(g_progress_world);
         }
-
-        m_is_dirty    = true;
-        m_state        = WorldState::Ticking;
-        ProgressReport::Get().SetIsLoading(g_progress_world, false);    
-        LOG_INFO("Loading took %.2f ms", timer.GetElapsedTimeMs());
-
-        FIRE_EVENT(EventType::WorldLoaded);
-        return true;
     }
 
     shared_ptr<Entity>& World::EntityCreate(bool is_active /*= true*/)
     {
-        auto& entity = m_entities.emplace_back(make_shared<Entity>(m_context));
+        auto entity = make_shared<Entity>(m_context);
         entity->SetActive(is_active);
-        return entity;
+
+        lock_guard<recursive_mutex> lock(m_mutex);
+        m_transforms_dirty = true;
+        return EntityIndexAdd(entity);
     }
 
     shared_ptr<Entity>& World::EntityAdd(const shared_ptr<Entity>& entity)
@@ -284,7 +669,9 @@ namespace Spartan
         if (!entity)
             return empty;
 
-        return m_entities.emplace_back(entity);
+        lock_guard<recursive_mutex> lock(m_mutex);
+        m_transforms_dirty = true;
+        return EntityIndexAdd(entity);
     }
 
     bool World::EntityExists(const shared_ptr<Entity>& entity)
@@ -302,12 +689,18 @@ namespace Spartan
 
         // Mark for destruction but don't delete now
         // as the Renderer might still be using it.
-        entity->MarkForDestruction();
-        m_is_dirty = true;
+        lock_guard<recursive_mutex> lock(m_mutex);
+        if (!entity->IsPendingDestruction())
+        {
+            entity->MarkForDestruction();
+            m_entities_pending_destruction.emplace_back(entity);
+        }
     }
 
     vector<shared_ptr<Entity>> World::EntityGetRoots()
     {
+        lock_guard<recursive_mutex> lock(m_mutex);
+
         vector<shared_ptr<Entity>> root_entities;
         for (const auto& entity : m_entities)
         {
@@ -322,57 +715,380 @@ namespace Spartan
 
     const shared_ptr<Entity>& World::EntityGetByName(const string& name)
     {
-        for (const auto& entity : m_entities)
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        // Names change often (e.g. while importing) but are rarely looked up, so the index is rebuilt lazily.
+        // The flag is cleared before rebuilding, so a rename which happens during the rebuild marks it dirty again.
+        if (m_entity_index_name_dirty.exchange(false))
         {
-            if (entity->GetName() == name)
-                return entity;
+            m_entity_index_name.clear();
+            for (const auto& entity : m_entities)
+            {
+                // The first entity with a given name wins, like a front to back search would
+                m_entity_index_name.emplace(entity->GetName(), entity->GetHandle().index);
+            }
         }
 
         static shared_ptr<Entity> empty;
-        return empty;
+        const auto it = m_entity_index_name.find(name);
+        return it != m_entity_index_name.end() ? m_entity_slots[it->second].entity : empty;
     }
 
     const shared_ptr<Entity>& World::EntityGetById(const uint32_t id)
     {
-        for (const auto& entity : m_entities)
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        static shared_ptr<Entity> empty;
+        const auto it = m_entity_index_id.find(id);
+        return it != m_entity_index_id.end() ? m_entity_slots[it->second].entity : empty;
+    }
+
+    const shared_ptr<Entity>& World::EntityGet(const EntityHandle& handle) const
+    {
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        static shared_ptr<Entity> empty;
+        if (handle.index >= static_cast<uint32_t>(m_entity_slots.size()))
+            return empty;
+
+        const EntitySlot& slot = m_entity_slots[handle.index];
+        return slot.generation == handle.generation ? slot.entity : empty;
+    }
+
+    void World::EntityIdChanged(Entity* entity, const uint32_t id_old)
+    {
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        const EntityHandle& handle = entity->GetHandle();
+        if (!handle.IsValid() || EntityGet(handle).get() != entity)
+            return;
+
+        const auto it = m_entity_index_id.find(id_old);
+        if (it != m_entity_index_id.end() && it->second == handle.index)
         {
-            if (entity->GetId() == id)
-                return entity;
+            m_entity_index_id.erase(it);
         }
 
-        static shared_ptr<Entity> empty;
-        return empty;
+        m_entity_index_id[entity->GetId()] = handle.index;
+    }
+
+    shared_ptr<Entity>& World::EntityIndexAdd(const shared_ptr<Entity>& entity)
+    {
+        // Already part of the world
+        if (entity->GetHandle().IsValid() && EntityGet(entity->GetHandle()) == entity)
+            return m_entities[m_entity_slots[entity->GetHandle().index].entities_index];
+
+        uint32_t index = 0;
+        if (!m_entity_slots_free.empty())
+        {
+            index = m_entity_slots_free.back();
+            m_entity_slots_free.pop_back();
+        }
+        else
+        {
+            index = static_cast<uint32_t>(m_entity_slots.size());
+            m_entity_slots.emplace_back();
+        }
+
+        EntitySlot& slot    = m_entity_slots[index];
+        slot.entity         = entity;
+        slot.entities_index = static_cast<uint32_t>(m_entities.size());
+        m_entities.emplace_back(entity);
+        entity->SetHandle(EntityHandle(index, slot.generation));
+
+        for (const auto& component : entity->GetAllComponents())
+        {
+            ComponentRegister(component.get());
+        }
+
+        m_entity_index_id[entity->GetId()] = index;
+        m_entity_index_name_dirty = true;
+
+        return m_entities[slot.entities_index];
+    }
+
+    void World::ComponentRegister(IComponent* component)
+    {
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        vector<IComponent*>& components = m_components[static_cast<uint32_t>(component->GetType())];
+        component->SetWorldIndex(static_cast<uint32_t>(components.size()));
+        components.emplace_back(component);
+
+        if (component->GetType() == ComponentType::Renderable)
+        {
+            BvhInsert(component->GetEntity());
+        }
+
+        if (m_renderer && component->GetEntity()->IsActive())
+        {
+            m_renderer->RenderablesAdd(component);
+        }
+    }
+
+    void World::ComponentUnregister(IComponent* component)
+    {
+        lock_guard<recursive_mutex> lock(m_mutex);
+
+        vector<IComponent*>& components = m_components[static_cast<uint32_t>(component->GetType())];
+        const uint32_t index = component->GetWorldIndex();
+        if (index >= static_cast<uint32_t>(components.size()) || components[index] != component)
+            return;
+
+        // Swap with the last one, so that removal doesn't shift the list
+        components[index] = components.back();
+        components[index]->SetWorldIndex(index);
+        components.pop_back();
+        component->SetWorldIndex(0xFFFFFFFF);
+
+        if (component->GetType() == ComponentType::Renderable)
+        {
+            BvhRemove(component->GetEntity());
+        }
+
+        if (m_renderer)
+        {
+            m_renderer->RenderablesRemove(component);
+        }
+    }
+
+    void World::EntityActiveChanged(Entity* entity)
+    {
+        if (!m_renderer)
+            return;
+
+        for (const auto& component : entity->GetAllComponents())
+        {
+            if (entity->IsActive())
+            {
+                m_renderer->RenderablesAdd(component.get());
+            }
+            else
+            {
+                m_renderer->RenderablesRemove(component.get());
+            }
+        }
+    }
+
+    void World::EntityIndexRemove(Entity* entity)
+    {
+        const EntityHandle handle = entity->GetHandle();
+        if (!handle.IsValid() || EntityGet(handle).get() != entity)
+            return;
+
+        const auto it = m_entity_index_id.find(entity->GetId());
+        if (it != m_entity_index_id.end() && it->second == handle.index)
+        {
+            m_entity_index_id.erase(it);
+        }
+
+        for (const auto& component : entity->GetAllComponents())
+        {
+            ComponentUnregister(component.get());
+        }
+
+        // Swap with the last entity and pop, the moved entity gets its position patched
+        EntitySlot& slot = m_entity_slots[handle.index];
+        const uint32_t entities_index = slot.entities_index;
+        if (entities_index != static_cast<uint32_t>(m_entities.size()) - 1)
+        {
+            m_entities[entities_index] = move(m_entities.back());
+            m_entity_slots[m_entities[entities_index]->GetHandle().index].entities_index = entities_index;
+        }
+        m_entities.pop_back();
+
+        // Bumping the generation invalidates any outstanding handles
+        slot.generation++;
+        m_entity_slots_free.emplace_back(handle.index);
+        m_entity_index_name_dirty = true;
+        entity->SetHandle(EntityHandle());
+
+        // Last, as this could be the final reference
+        slot.entity.reset();
     }
 
     // Removes an entity and all of it's children
     void World::_EntityRemove(const std::shared_ptr<Entity>& entity)
     {
-        // Remove any descendants
-        auto children = entity->GetTransform()->GetChildren();
-        for (const auto& child : children)
+        // Already removed (e.g. along with an ancestor which was also marked for destruction)
+        if (!entity->GetHandle().IsValid())
+            return;
+
+        // Remove any descendants (iterating a copy, as they unlink themselves from this entity). Back to front,
+        // as children are looked up from the back when unlinked, so that every removal finds its child right away.
+        const vector<Transform*> children = entity->GetTransform()->GetChildren();
+        for (auto it = children.rbegin(); it != children.rend(); it++)
         {
-            EntityRemove(child->GetEntity()->GetPtrShared());
+            _EntityRemove((*it)->GetEntity()->GetPtrShared());
         }
 
-        // Keep a reference to it's parent (in case it has one)
-        auto parent = entity->GetTransform()->GetParent();
+        // If there is a parent, make it forget about this entity
+        entity->GetTransform()->BecomeOrphan();
 
         // Remove this entity
-        for (auto it = m_entities.begin(); it < m_entities.end();)
+        EntityIndexRemove(entity.get());
+        m_transforms_dirty = true;
+    }
+
+    void World::BvhInsert(Entity* entity)
+    {
+        const uint32_t handle_index = entity->GetHandle().index;
+        if (handle_index >= static_cast<uint32_t>(m_bvh_proxies.size()))
+        {
+            m_bvh_proxies.resize(handle_index + 1, bvh_proxy_none);
+        }
+
+        if (m_bvh_proxies[handle_index] != bvh_proxy_none)
+            return;
+
+        // The bounds are likely not known yet (geometry and transform usually come after the component), they follow as updates
+        const BoundingBox box = get_bvh_box(entity, entity->GetRenderable());
+        unique_lock<shared_mutex> lock(m_bvh_mutex);
+        m_bvh_proxies[handle_index] = m_bvh.Insert(box, entity);
+    }
+
+    void World::BvhRemove(Entity* entity)
+    {
+        const uint32_t handle_index = entity->GetHandle().index;
+        if (handle_index >= static_cast<uint32_t>(m_bvh_proxies.size()) || m_bvh_proxies[handle_index] == bvh_proxy_none)
+            return;
+
+        {
+            unique_lock<shared_mutex> lock(m_bvh_mutex);
+            m_bvh.Remove(m_bvh_proxies[handle_index]);
+        }
+        m_bvh_proxies[handle_index] = bvh_proxy_none;
+    }
+
+    void World::RenderableBoundsChanged(Entity* entity)
+    {
+        if (!entity->GetHandle().IsValid())
+            return;
+
+        lock_guard<mutex> lock(m_bvh_dirty_mutex);
+        m_bvh_dirty.emplace_back(entity->GetHandle().index);
+    }
+
+    void World::BvhUpdate()
+    {
+        vector<uint32_t> dirty;
+        {
+            lock_guard<mutex> lock(m_bvh_dirty_mutex);
+            if (m_bvh_dirty.empty())
+                return;
+
+            dirty.swap(m_bvh_dirty);
+        }
+
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        // Leaves are loose, so only entities which moved noticeably are re-inserted. The slot might have been
+        // freed (or reused) since the index was queued, which is harmless as whatever is there now gets updated.
+        unique_lock<shared_mutex> lock(m_bvh_mutex);
+        for (const uint32_t handle_index : dirty)
+        {
+            if (handle_index >= static_cast<uint32_t>(m_bvh_proxies.size()) || m_bvh_proxies[handle_index] == bvh_proxy_none)
+                continue;
+
+            Entity* entity = m_entity_slots[handle_index].entity.get();
+            if (Renderable* renderable = entity ? entity->GetRenderable() : nullptr)
+            {
+                m_bvh.Update(m_bvh_proxies[handle_index], get_bvh_box(entity, renderable));
+            }
+        }
+    }
+
+    void World::TransformsRebuild()
+    {
+        m_transforms.clear();
+        m_transform_levels.clear();
+
+        // Breadth first from the roots, so each level only has parents in the levels before it
+        for (const auto& entity : m_entities)
         {
-            const auto temp = *it;
-            if (temp->GetId() == entity->GetId())
+            Transform* transform = entity->GetTransform();
+            if (transform->IsRoot())
             {
-                it = m_entities.erase(it);
-                break;
+                m_transforms.emplace_back(transform);
+            }
+        }
+
+        uint32_t level_start = 0;
+        while (level_start < static_cast<uint32_t>(m_transforms.size()))
+        {
+            const uint32_t level_end = static_cast<uint32_t>(m_transforms.size());
+            m_transform_levels.emplace_back(level_start);
+
+            for (uint32_t i = level_start; i < level_end; i++)
+            {
+                for (Transform* child : m_transforms[i]->GetChildren())
+                {
+                    m_transforms.emplace_back(child);
+                }
             }
-            ++it;
+
+            level_start = level_end;
         }
+        m_transform_levels.emplace_back(static_cast<uint32_t>(m_transforms.size()));
+
+        m_transforms_dirty = false;
+    }
 
-        // If there was a parent, update it
-        if (parent)
+    void World::TransformsUpdate()
+    {
+        SCOPED_TIME_BLOCK(m_profiler);
+
+        if (m_transforms_dirty)
         {
-            parent->AcquireChildren();
+            TransformsRebuild();
+        }
+
+        // Transforms only read their parent, which is a level above and already up to date, so a level can go wide.
+        // Whatever moved (even if its matrix was already computed when read) is queued for the BVH to follow.
+        const auto update = [this](const uint32_t start, const uint32_t end)
+        {
+            vector<uint32_t> moved;
+
+            for (uint32_t i = start; i < end; i++)
+            {
+                Transform* transform = m_transforms[i];
+
+                if (transform->IsDirty())
+                {
+                    transform->UpdateTransform();
+                }
+
+                if (transform->HasMoved())
+                {
+                    transform->ClearMoved();
+
+                    if (transform->GetEntity()->GetRenderable())
+                    {
+                        moved.emplace_back(transform->GetEntity()->GetHandle().index);
+                    }
+                }
+            }
+
+            if (!moved.empty())
+            {
+                lock_guard<mutex> lock(m_bvh_dirty_mutex);
+                m_bvh_dirty.insert(m_bvh_dirty.end(), moved.begin(), moved.end());
+            }
+        };
+
+        for (uint32_t level = 0; level + 1 < static_cast<uint32_t>(m_transform_levels.size()); level++)
+        {
+            const uint32_t start = m_transform_levels[level];
+            const uint32_t count = m_transform_levels[level + 1] - start;
+
+            if (count >= transform_parallel_threshold)
+            {
+                m_threading->AddTaskLoop([&update, start](uint32_t i_start, uint32_t i_end) { update(start + i_start, start + i_end); }, count);
+            }
+            else
+            {
+                update(start, start + count);
+            }
         }
     }
 
@@ -25,16 +25,27 @@ CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 #include <vector>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <array>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
 #include "../Core/ISubsystem.h"
 #include "../Core/Spartan_Definitions.h"
+#include "../Math/BoundingVolumeHierarchy.h"
+#include "EntityHandle.h"
+#include "Components/IComponent.h"
 //======================================
 
 namespace Spartan
 {
     class Entity;
+    class Transform;
     class Light;
     class Input;
     class Profiler;
+    class Threading;
+    class Renderer;
 
     enum class WorldState
     {
@@ -59,7 +70,6 @@ namespace Spartan
         bool SaveToFile(const std::string& filePath);
         bool LoadFromFile(const std::string& file_path);
         const auto& GetName() const { return m_name; }
-        void MakeDirty() { m_is_dirty = true; }
 
         //= Entities ===========================================================================
         std::shared_ptr<Entity>& EntityCreate(bool is_active = true);
@@ -69,12 +79,94 @@ namespace Spartan
         std::vector<std::shared_ptr<Entity>> EntityGetRoots();
         const std::shared_ptr<Entity>& EntityGetByName(const std::string& name);
         const std::shared_ptr<Entity>& EntityGetById(uint32_t id);
+        const std::shared_ptr<Entity>& EntityGet(const EntityHandle& handle) const;
         const auto& EntityGetAll() const    { return m_entities; }
         auto EntityGetCount() const         { return static_cast<uint32_t>(m_entities.size()); }
         //======================================================================================
 
+        //= Components =========================================================================
+        // Invokes function(T*) for every component of type T in the world
+        template <typename T, typename Function>
+        void ForEachComponent(Function&& function) const
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            for (IComponent* component : m_components[static_cast<uint32_t>(IComponent::TypeToEnum<T>())])
+            {
+                function(static_cast<T*>(component));
+            }
+        }
+
+        // Invokes function(T*, U*) for every entity in the world which has both components
+        template <typename T, typename U, typename Function>
+        void ForEachComponent(Function&& function) const
+        {
+            std::lock_guard<std::recursive_mutex> lock(m_mutex);
+            const std::vector<IComponent*>& components_t = m_components[static_cast<uint32_t>(IComponent::TypeToEnum<T>())];
+            const std::vector<IComponent*>& components_u = m_components[static_cast<uint32_t>(IComponent::TypeToEnum<U>())];
+
+            // Walk the shorter list, the other component is a direct lookup on the entity
+            if (components_t.size() <= components_u.size())
+            {
+                for (IComponent* component : components_t)
+                {
+                    if (U* other = component->GetEntity()->template GetComponent<U>())
+                    {
+                        function(static_cast<T*>(component), other);
+                    }
+                }
+            }
+            else
+            {
+                for (IComponent* component : components_u)
+                {
+                    if (T* other = component->GetEntity()->template GetComponent<T>())
+                    {
+                        function(other, static_cast<U*>(component));
+                    }
+                }
+            }
+        }
+
+        const std::vector<IComponent*>& GetComponents(const ComponentType type) const { return m_components[static_cast<uint32_t>(type)]; }
+
+        // Entities call these as components are added and removed
+        void ComponentRegister(IComponent* component);
+        void ComponentUnregister(IComponent* component);
+
+        // Entities call this when they get (de)activated, so that the renderer only tracks active ones
+        void EntityActiveChanged(Entity* entity);
+        //======================================================================================
+
+        // Entities with a renderable, spatially partitioned (the user data of each leaf is the Entity*). Renderables can be added
+        // and removed from any thread, so the tree is only lent to function(bvh), during which it doesn't change and its entities stay alive.
+        template <typename Function>
+        void BvhRead(Function&& function) const
+        {
+            std::shared_lock<std::shared_mutex> lock(m_bvh_mutex);
+            function(static_cast<const Math::BoundingVolumeHierarchy&>(m_bvh));
+        }
+
+        // Renderables call this when their geometry (and therefore their bounds) changes, safe to call from any thread
+        void RenderableBoundsChanged(Entity* entity);
+
+        // Entities call these when their id or name changes, so that the lookups stay in sync
+        void EntityIdChanged(Entity* entity, uint32_t id_old);
+        void EntityNameChanged() { m_entity_index_name_dirty = true; }
+
+        // Transforms call this when they change parent, so that the update order gets rebuilt
+        void TransformHierarchyChanged() { m_transforms_dirty = true; }
+
     private:
+        bool FileLoad(FileStream* file, const std::string& file_path);
+        void FileLoadLegacy(FileStream* file);
         void _EntityRemove(const std::shared_ptr<Entity>& entity);
+        std::shared_ptr<Entity>& EntityIndexAdd(const std::shared_ptr<Entity>& entity);
+        void EntityIndexRemove(Entity* entity);
+        void BvhInsert(Entity* entity);
+        void BvhRemove(Entity* entity);
+        void BvhUpdate();
+        void TransformsRebuild();
+        void TransformsUpdate();
 
         //= COMMON ENTITY CREATION ========================
         std::shared_ptr<Entity>& CreateEnvironment();
@@ -84,11 +176,46 @@ namespace Spartan
 
         std::string m_name;
         bool m_was_in_editor_mode   = false;
-        bool m_is_dirty             = true;
         WorldState m_state          = WorldState::Ticking;
         Input* m_input              = nullptr;
         Profiler* m_profiler        = nullptr;
+        Threading* m_threading      = nullptr;
+        Renderer* m_renderer        = nullptr;
 
         std::vector<std::shared_ptr<Entity>> m_entities;
+        std::vector<std::shared_ptr<Entity>> m_entities_pending_destruction;
+
+        // Entity lookups, handles index the slots and the ids and names map to them
+        struct EntitySlot
+        {
+            std::shared_ptr<Entity> entity;
+            uint32_t generation     = 0;
+            uint32_t entities_index = 0; // where the entity is in m_entities, so that it can be removed without a search
+        };
+        std::vector<EntitySlot> m_entity_slots;
+        std::vector<uint32_t> m_entity_slots_free;
+        std::unordered_map<uint32_t, uint32_t> m_entity_index_id;
+        std::unordered_map<std::string, uint32_t> m_entity_index_name; // built when first needed after a name changes
+        std::atomic<bool> m_entity_index_name_dirty = true; // set without the lock, entities are renamed on import threads
+
+        // All the components of the entities in the world, per type
+        std::array<std::vector<IComponent*>, component_type_count> m_components;
+
+        // Entities and components can be added from any thread (e.g. while a model is imported), this serializes that against
+        // the tick and the lookups. Recursive, as ticking, adding and removing can all end up adding or removing more.
+        mutable std::recursive_mutex m_mutex;
+
+        // Spatial partitioning, the proxies are indexed by entity handle and only the entities which moved are updated
+        static constexpr uint32_t bvh_proxy_none = 0xFFFFFFFF;
+        Math::BoundingVolumeHierarchy m_bvh;
+        mutable std::shared_mutex m_bvh_mutex; // writers take it exclusively, after m_mutex
+        std::vector<uint32_t> m_bvh_proxies;
+        std::vector<uint32_t> m_bvh_dirty; // entity handle indices
+        std::mutex m_bvh_dirty_mutex;
+
+        // All transforms sorted by depth (parents before children), and where each depth level starts
+        std::vector<Transform*> m_transforms;
+        std::vector<uint32_t> m_transform_levels;
+        bool m_transforms_dirty = true;
     };
 }